@@ -259,6 +259,150 @@ void fnlDomainWarp2D(fnl_state *state, FNLfloat *x, FNLfloat *y);
  */
 void fnlDomainWarp3D(fnl_state *state, FNLfloat *x, FNLfloat *y, FNLfloat *z);
 
+/**
+ * Number of FNLfloat values of plan storage needed per point.
+ */
+#define FNL_PLAN_3D_TERMS 4
+
+/**
+ * Evaluation plan for 3D noise over a fixed set of (x, y) points where only z changes between evaluations.
+ * @note Must only be created using fnlCreatePlan3D(...). Later changes to the source state are not seen by the plan.
+ */
+typedef struct fnl_plan_3d
+{
+    /**
+     * Copy of the state the plan was created from.
+     */
+    fnl_state state;
+
+    /**
+     * Number of planned points.
+     */
+    int count;
+
+    /**
+     * Precomputed z independent terms, FNL_PLAN_3D_TERMS per point.
+     * @remark Caller owned storage.
+     */
+    FNLfloat *terms;
+} fnl_plan_3d;
+
+/**
+ * Precomputes everything fnlGetNoise3D does for each (x[i], y[i]) that does not depend on z.
+ * This covers the frequency multiply and the parts of the 3D rotation or skew that only involve x and y.
+ * @param terms Storage for at least count*FNL_PLAN_3D_TERMS values. Must outlive the plan.
+ */
+fnl_plan_3d fnlCreatePlan3D(fnl_state *state, const FNLfloat *x, const FNLfloat *y, int count, FNLfloat *terms);
+
+/**
+ * 3D noise at every planned point for the given z, written to out[i*stride].
+ *
+ * Output is bit-identical to:
+ * ```
+ * out[i*stride] = fnlGetNoise3D(&state, x[i], y[i], z);
+ * ```
+ */
+void fnlGetNoisePlan3D(fnl_plan_3d *plan, FNLfloat z, float *out, int stride);
+
+/**
+ * 3D noise at given position using the state settings, along with its derivative along each input axis.
+ * @param dx,dy,dz Receive the partial derivatives. Any of them may be NULL.
+ * @returns The same value as fnlGetNoise3D.
+ * @remark OpenSimplex2 is differentiated analytically in the same pass, other noise types fall back to central differences.
+ */
+float fnlGetNoiseDeriv3D(fnl_state *state, FNLfloat x, FNLfloat y, FNLfloat z, float *dx, float *dy, float *dz);
+
+/**
+ * 3D noise and its derivatives at every planned point for the given z, written to out[i*stride], dx[i*stride], dy[i*stride] and dz[i*stride].
+ * Any of dx, dy, dz may be NULL.
+ *
+ * Output is identical to:
+ * ```
+ * out[i*stride] = fnlGetNoiseDeriv3D(&state, x[i], y[i], z, &dx[i*stride], &dy[i*stride], &dz[i*stride]);
+ * ```
+ */
+void fnlGetNoisePlanDeriv3D(fnl_plan_3d *plan, FNLfloat z, float *out, float *dx, float *dy, float *dz, int stride);
+
+/**
+ * Grid of noise values for fnlGenNoiseImage2D/3D to fill.
+ * Sample (i, j, k) is data[(k * height + j) * width + i], taken at (x + i * step_x, y + j * step_y, z + k * step_z).
+ */
+typedef struct fnl_image
+{
+    /**
+     * Output, width * height * depth values.
+     */
+    float *data;
+
+    int width;
+    int height;
+
+    /**
+     * Ignored by fnlGenNoiseImage2D.
+     */
+    int depth;
+
+    /**
+     * Position of data[0].
+     */
+    FNLfloat x, y, z;
+
+    /**
+     * Distance between neighbouring samples along each axis.
+     */
+    FNLfloat step_x, step_y, step_z;
+} fnl_image;
+
+/**
+ * Caller provided thread pool for the image functions.
+ */
+typedef struct fnl_pool
+{
+    /**
+     * Calls task(context, i) for every i in [0, count) and returns once all have returned.
+     * Tasks write separate parts of the image, so they may run in any order and on any thread, the caller's included.
+     */
+    void (*parallel_for)(void *pool, void (*task)(void *context, int index), void *context, int count);
+
+    /**
+     * Passed back to parallel_for.
+     */
+    void *pool;
+} fnl_pool;
+
+/**
+ * Edge length of the square (2D) or cubic (3D) tiles the image functions split their work into.
+ * A tile's output and the noise state stay in cache while it is filled.
+ */
+#define FNL_IMAGE_TILE_2D 32
+#define FNL_IMAGE_TILE_3D 16
+
+/**
+ * Fills a 2D image with noise, one tile per task.
+ * @param warp Domain warp applied to each position first, as with fnlDomainWarp2D. May be NULL.
+ * @param pool Runs the tiles. May be NULL to fill the image on the calling thread.
+ *
+ * Output is identical to:
+ * ```
+ * fnlDomainWarp2D(warp, &x, &y); // If warp is given
+ * data[j * width + i] = fnlGetNoise2D(state, x, y);
+ * ```
+ */
+void fnlGenNoiseImage2D(fnl_state *state, fnl_state *warp, fnl_image *image, const fnl_pool *pool);
+
+/**
+ * Fills a 3D volume with noise, one tile per task.
+ * @param warp Domain warp applied to each position first, as with fnlDomainWarp3D. May be NULL.
+ * @param pool Runs the tiles. May be NULL to fill the volume on the calling thread.
+ *
+ * Output is identical to:
+ * ```
+ * fnlDomainWarp3D(warp, &x, &y, &z); // If warp is given
+ * data[(k * height + j) * width + i] = fnlGetNoise3D(state, x, y, z);
+ * ```
+ */
+void fnlGenNoiseImage3D(fnl_state *state, fnl_state *warp, fnl_image *image, const fnl_pool *pool);
+
 // ====================
 // Below this line is the implementation
 // ====================
@@ -1073,6 +1217,125 @@ static float _fnlSingleOpenSimplex23D(int seed, FNLfloat x, FNLfloat y, FNLfloat
     return value * 32.69428253173828125f;
 }
 
+static inline float _fnlGradCoordDeriv3D(int seed, int xPrimed, int yPrimed, int zPrimed, float xd, float yd, float zd, float *g)
+{
+    int hash = _fnlHash3D(seed, xPrimed, yPrimed, zPrimed);
+    hash ^= hash >> 15;
+    hash &= 63 << 2;
+    g[0] = GRADIENTS_3D[hash];
+    g[1] = GRADIENTS_3D[hash | 1];
+    g[2] = GRADIENTS_3D[hash | 2];
+    return xd * g[0] + yd * g[1] + zd * g[2];
+}
+
+// Same walk as _fnlSingleOpenSimplex23D. Each vertex adds a^4 * dot(g, d) with a = 0.6 - |d|^2,
+// whose derivative is a^4 * g - 8 * a^3 * dot(g, d) * d.
+static float _fnlSingleOpenSimplex2Deriv3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z, float *deriv)
+{
+    int i = _fnlFastRound(x);
+    int j = _fnlFastRound(y);
+    int k = _fnlFastRound(z);
+    float x0 = (float)(x - i);
+    float y0 = (float)(y - j);
+    float z0 = (float)(z - k);
+
+    int xNSign = (int)(-1.0f - x0) | 1;
+    int yNSign = (int)(-1.0f - y0) | 1;
+    int zNSign = (int)(-1.0f - z0) | 1;
+
+    float ax0 = xNSign * -x0;
+    float ay0 = yNSign * -y0;
+    float az0 = zNSign * -z0;
+
+    i *= PRIME_X;
+    j *= PRIME_Y;
+    k *= PRIME_Z;
+
+    float value = 0;
+    float dx = 0, dy = 0, dz = 0;
+    float g[3];
+    float a = (0.6f - x0 * x0) - (y0 * y0 + z0 * z0);
+
+    for (int l = 0; ; l++)
+    {
+        if (a > 0)
+        {
+            float dot = _fnlGradCoordDeriv3D(seed, i, j, k, x0, y0, z0, g);
+            float a4 = (a * a) * (a * a);
+            float falloff = -8 * (a * a) * a * dot;
+            value += a4 * dot;
+            dx += a4 * g[0] + falloff * x0;
+            dy += a4 * g[1] + falloff * y0;
+            dz += a4 * g[2] + falloff * z0;
+        }
+
+        float b = a + 1;
+        int i1 = i;
+        int j1 = j;
+        int k1 = k;
+        float x1 = x0;
+        float y1 = y0;
+        float z1 = z0;
+        if (ax0 >= ay0 && ax0 >= az0)
+        {
+            x1 += xNSign;
+            b -= xNSign * 2 * x1;
+            i1 -= xNSign * PRIME_X;
+        }
+        else if (ay0 > ax0 && ay0 >= az0)
+        {
+            y1 += yNSign;
+            b -= yNSign * 2 * y1;
+            j1 -= yNSign * PRIME_Y;
+        }
+        else
+        {
+            z1 += zNSign;
+            b -= zNSign * 2 * z1;
+            k1 -= zNSign * PRIME_Z;
+        }
+
+        if (b > 0)
+        {
+            float dot = _fnlGradCoordDeriv3D(seed, i1, j1, k1, x1, y1, z1, g);
+            float b4 = (b * b) * (b * b);
+            float falloff = -8 * (b * b) * b * dot;
+            value += b4 * dot;
+            dx += b4 * g[0] + falloff * x1;
+            dy += b4 * g[1] + falloff * y1;
+            dz += b4 * g[2] + falloff * z1;
+        }
+
+        if (l == 1)
+            break;
+
+        ax0 = 0.5f - ax0;
+        ay0 = 0.5f - ay0;
+        az0 = 0.5f - az0;
+
+        x0 = xNSign * ax0;
+        y0 = yNSign * ay0;
+        z0 = zNSign * az0;
+
+        a += (0.75f - ax0) - (ay0 + az0);
+
+        i += (xNSign >> 1) & PRIME_X;
+        j += (yNSign >> 1) & PRIME_Y;
+        k += (zNSign >> 1) & PRIME_Z;
+
+        xNSign = -xNSign;
+        yNSign = -yNSign;
+        zNSign = -zNSign;
+
+        seed = ~seed;
+    }
+
+    deriv[0] = dx * 32.69428253173828125f;
+    deriv[1] = dy * 32.69428253173828125f;
+    deriv[2] = dz * 32.69428253173828125f;
+    return value * 32.69428253173828125f;
+}
+
 // OpenSimplex2S Noise
 
 static float _fnlSingleOpenSimplex2S2D(int seed, FNLfloat x, FNLfloat y)
@@ -2332,6 +2595,206 @@ static void _fnlSingleDomainWarpOpenSimplex2Gradient(int seed, float warpAmp, fl
     *zr += vz * warpAmp;
 }
 
+// Select a fractal type for already transformed coordinates
+
+static inline float _fnlGenNoiseTransformed3D(fnl_state *state, FNLfloat x, FNLfloat y, FNLfloat z)
+{
+    switch (state->fractal_type)
+    {
+    default:
+        return _fnlGenNoiseSingle3D(state, state->seed, x, y, z);
+    case FNL_FRACTAL_FBM:
+        return _fnlGenFractalFBM3D(state, x, y, z);
+    case FNL_FRACTAL_RIDGED:
+        return _fnlGenFractalRidged3D(state, x, y, z);
+    case FNL_FRACTAL_PINGPONG:
+        return _fnlGenFractalPingPong3D(state, x, y, z);
+    }
+}
+
+// Noise Derivatives
+// Values match the plain path exactly; derivatives are taken with respect to the transformed coordinates
+// and brought back to input space by _fnlTransformNoiseGradient3D.
+
+static inline float _fnlGenNoiseSingleDeriv3D(fnl_state *state, int seed, FNLfloat x, FNLfloat y, FNLfloat z, float *deriv)
+{
+    if (state->noise_type == FNL_NOISE_OPENSIMPLEX2)
+        return _fnlSingleOpenSimplex2Deriv3D(seed, x, y, z, deriv);
+
+    const FNLfloat h = (FNLfloat)1e-3;
+    deriv[0] = (_fnlGenNoiseSingle3D(state, seed, x + h, y, z) - _fnlGenNoiseSingle3D(state, seed, x - h, y, z)) / (float)(2 * h);
+    deriv[1] = (_fnlGenNoiseSingle3D(state, seed, x, y + h, z) - _fnlGenNoiseSingle3D(state, seed, x, y - h, z)) / (float)(2 * h);
+    deriv[2] = (_fnlGenNoiseSingle3D(state, seed, x, y, z + h) - _fnlGenNoiseSingle3D(state, seed, x, y, z - h)) / (float)(2 * h);
+    return _fnlGenNoiseSingle3D(state, seed, x, y, z);
+}
+
+// Mirrors _fnlGenNoiseTransformed3D. Weighted strength makes each octave's amplitude depend on the octaves before it,
+// so the amplitude's derivative is carried along with it.
+static inline float _fnlGenNoiseTransformedDeriv3D(fnl_state *state, FNLfloat x, FNLfloat y, FNLfloat z, float *deriv)
+{
+    if (state->fractal_type != FNL_FRACTAL_FBM && state->fractal_type != FNL_FRACTAL_RIDGED && state->fractal_type != FNL_FRACTAL_PINGPONG)
+        return _fnlGenNoiseSingleDeriv3D(state, state->seed, x, y, z, deriv);
+
+    int seed = state->seed;
+    float sum = 0;
+    float amp = _fnlCalculateFractalBounding(state);
+    float ampDeriv[3] = { 0, 0, 0 };
+    float scale = 1;
+    deriv[0] = deriv[1] = deriv[2] = 0;
+
+    for (int i = 0; i < state->octaves; i++)
+    {
+        float g[3];
+        float single = _fnlGenNoiseSingleDeriv3D(state, seed++, x, y, z, g);
+        float noise, weight, slope, weightSlope;
+
+        // slope: d(contribution)/d(single), weightSlope: d(weight)/d(single)
+        switch (state->fractal_type)
+        {
+        default:
+            noise = single;
+            sum += noise * amp;
+            slope = 1;
+            weight = _fnlLerp(1.0f, (noise + 1) * 0.5f, state->weighted_strength);
+            weightSlope = 0.5f * state->weighted_strength;
+            break;
+        case FNL_FRACTAL_RIDGED:
+        {
+            float sign = single < 0 ? -1.0f : 1.0f;
+            noise = _fnlFastAbs(single);
+            sum += (noise * -2 + 1) * amp;
+            slope = -2 * sign;
+            weight = _fnlLerp(1.0f, 1 - noise, state->weighted_strength);
+            weightSlope = -sign * state->weighted_strength;
+        }
+        break;
+        case FNL_FRACTAL_PINGPONG:
+        {
+            float t = (single + 1) * state->ping_pong_strength;
+            t -= (int)(t * 0.5f) * 2;
+            float sign = (t < 1 ? 1.0f : -1.0f) * state->ping_pong_strength;
+            noise = _fnlPingPong((single + 1) * state->ping_pong_strength);
+            sum += (noise - 0.5f) * 2 * amp;
+            slope = 2 * sign;
+            weight = _fnlLerp(1.0f, noise, state->weighted_strength);
+            weightSlope = sign * state->weighted_strength;
+        }
+        break;
+        }
+
+        float contribution = noise;
+        if (state->fractal_type == FNL_FRACTAL_RIDGED)
+            contribution = noise * -2 + 1;
+        else if (state->fractal_type == FNL_FRACTAL_PINGPONG)
+            contribution = (noise - 0.5f) * 2;
+
+        for (int a = 0; a < 3; a++)
+        {
+            float d = g[a] * scale;
+            deriv[a] += slope * d * amp + contribution * ampDeriv[a];
+            ampDeriv[a] = (ampDeriv[a] * weight + amp * weightSlope * d) * state->gain;
+        }
+        amp *= weight;
+
+        x *= state->lacunarity;
+        y *= state->lacunarity;
+        z *= state->lacunarity;
+        scale *= state->lacunarity;
+        amp *= state->gain;
+    }
+
+    return sum;
+}
+
+// Applies the transpose of _fnlTransformNoiseCoordinate3D to a derivative taken in transformed coordinates
+static inline void _fnlTransformNoiseGradient3D(fnl_state *state, float *deriv)
+{
+    float x = deriv[0], y = deriv[1], z = deriv[2];
+
+    switch (state->rotation_type_3d)
+    {
+    case FNL_ROTATION_IMPROVE_XY_PLANES:
+    {
+        float s2 = (x + y) * -0.211324865405187f;
+        float zs = z * 0.577350269189626f;
+        deriv[0] = x + s2 + zs;
+        deriv[1] = y + s2 + zs;
+        deriv[2] = (z - x - y) * 0.577350269189626f;
+    }
+    break;
+    case FNL_ROTATION_IMPROVE_XZ_PLANES:
+    {
+        float s2 = (x + z) * -0.211324865405187f;
+        float ys = y * 0.577350269189626f;
+        deriv[0] = x + s2 + ys;
+        deriv[2] = z + s2 + ys;
+        deriv[1] = (y - x - z) * 0.577350269189626f;
+    }
+    break;
+    default:
+        switch (state->noise_type)
+        {
+        case FNL_NOISE_OPENSIMPLEX2:
+        case FNL_NOISE_OPENSIMPLEX2S:
+        {
+            float r = (x + y + z) * (2.0f / 3.0f);
+            deriv[0] = r - x;
+            deriv[1] = r - y;
+            deriv[2] = r - z;
+        }
+        break;
+        default:
+            break;
+        }
+    }
+
+    deriv[0] *= state->frequency;
+    deriv[1] *= state->frequency;
+    deriv[2] *= state->frequency;
+}
+
+static inline void _fnlStoreDeriv3D(const float *deriv, float *dx, float *dy, float *dz)
+{
+    if (dx)
+        *dx = deriv[0];
+    if (dy)
+        *dy = deriv[1];
+    if (dz)
+        *dz = deriv[2];
+}
+
+// Planned Noise Coordinate Transforms
+// Splits _fnlTransformNoiseCoordinate3D into a z independent half done once per point and a z dependent half done per evaluation.
+// Operation order is kept identical to the unsplit transform so results match bit for bit.
+
+typedef enum
+{
+    _FNL_PLAN_SCALE,
+    _FNL_PLAN_ROTATE,
+    _FNL_PLAN_IMPROVE_XY,
+    _FNL_PLAN_IMPROVE_XZ
+} _fnl_plan_kind;
+
+static _fnl_plan_kind _fnlPlanKind3D(fnl_state *state)
+{
+    switch (state->rotation_type_3d)
+    {
+    case FNL_ROTATION_IMPROVE_XY_PLANES:
+        return _FNL_PLAN_IMPROVE_XY;
+    case FNL_ROTATION_IMPROVE_XZ_PLANES:
+        return _FNL_PLAN_IMPROVE_XZ;
+    default:
+        switch (state->noise_type)
+        {
+        case FNL_NOISE_OPENSIMPLEX2:
+        case FNL_NOISE_OPENSIMPLEX2S:
+            return _FNL_PLAN_ROTATE;
+        default:
+            return _FNL_PLAN_SCALE;
+        }
+    }
+}
+
 // ====================
 // Public API
 // ====================
@@ -2378,18 +2841,18 @@ float fnlGetNoise3D(fnl_state *state, FNLfloat x, FNLfloat y, FNLfloat z)
 {
     _fnlTransformNoiseCoordinate3D(state, &x, &y, &z);
 
-    // Select a noise type
-    switch (state->fractal_type)
-    {
-    default:
-        return _fnlGenNoiseSingle3D(state, state->seed, x, y, z);
-    case FNL_FRACTAL_FBM:
-        return _fnlGenFractalFBM3D(state, x, y, z);
-    case FNL_FRACTAL_RIDGED:
-        return _fnlGenFractalRidged3D(state, x, y, z);
-    case FNL_FRACTAL_PINGPONG:
-        return _fnlGenFractalPingPong3D(state, x, y, z);
-    }
+    return _fnlGenNoiseTransformed3D(state, x, y, z);
+}
+
+float fnlGetNoiseDeriv3D(fnl_state *state, FNLfloat x, FNLfloat y, FNLfloat z, float *dx, float *dy, float *dz)
+{
+    _fnlTransformNoiseCoordinate3D(state, &x, &y, &z);
+
+    float deriv[3];
+    float value = _fnlGenNoiseTransformedDeriv3D(state, x, y, z, deriv);
+    _fnlTransformNoiseGradient3D(state, deriv);
+    _fnlStoreDeriv3D(deriv, dx, dy, dz);
+    return value;
 }
 
 void fnlDomainWarp2D(fnl_state *state, FNLfloat *x, FNLfloat *y)
@@ -2424,6 +2887,220 @@ void fnlDomainWarp3D(fnl_state *state, FNLfloat *x, FNLfloat *y, FNLfloat *z)
     }
 }
 
+fnl_plan_3d fnlCreatePlan3D(fnl_state *state, const FNLfloat *x, const FNLfloat *y, int count, FNLfloat *terms)
+{
+    fnl_plan_3d plan;
+    plan.state = *state;
+    plan.count = count;
+    plan.terms = terms;
+
+    _fnl_plan_kind kind = _fnlPlanKind3D(state);
+    for (int i = 0; i < count; i++)
+    {
+        FNLfloat xf = x[i] * state->frequency;
+        FNLfloat yf = y[i] * state->frequency;
+        FNLfloat *t = terms + i * FNL_PLAN_3D_TERMS;
+
+        switch (kind)
+        {
+        case _FNL_PLAN_SCALE:
+            t[0] = xf;
+            t[1] = yf;
+            t[2] = 0;
+            t[3] = 0;
+            break;
+        case _FNL_PLAN_ROTATE:
+            t[0] = xf;
+            t[1] = yf;
+            t[2] = xf + yf;
+            t[3] = 0;
+            break;
+        case _FNL_PLAN_IMPROVE_XY:
+        {
+            FNLfloat xy = xf + yf;
+            FNLfloat s2 = xy * -(FNLfloat)0.211324865405187;
+            t[0] = xf;
+            t[1] = s2;
+            t[2] = yf + s2;
+            t[3] = xy * (FNLfloat)0.577350269189626;
+        }
+        break;
+        case _FNL_PLAN_IMPROVE_XZ:
+            t[0] = xf;
+            t[1] = yf * (FNLfloat)0.577350269189626;
+            t[2] = 0;
+            t[3] = 0;
+            break;
+        }
+    }
+
+    return plan;
+}
+
+void fnlGetNoisePlan3D(fnl_plan_3d *plan, FNLfloat z, float *out, int stride)
+{
+    fnl_state *state = &plan->state;
+    const FNLfloat *t = plan->terms;
+    FNLfloat zf = z * state->frequency;
+
+    switch (_fnlPlanKind3D(state))
+    {
+    case _FNL_PLAN_SCALE:
+        for (int i = 0; i < plan->count; i++, t += FNL_PLAN_3D_TERMS)
+            out[i * stride] = _fnlGenNoiseTransformed3D(state, t[0], t[1], zf);
+        break;
+    case _FNL_PLAN_ROTATE:
+    {
+        const FNLfloat R3 = (FNLfloat)(2.0 / 3.0);
+        for (int i = 0; i < plan->count; i++, t += FNL_PLAN_3D_TERMS)
+        {
+            FNLfloat r = (t[2] + zf) * R3; // Rotation, not skew
+            out[i * stride] = _fnlGenNoiseTransformed3D(state, r - t[0], r - t[1], r - zf);
+        }
+    }
+    break;
+    case _FNL_PLAN_IMPROVE_XY:
+    {
+        FNLfloat zs = zf * (FNLfloat)0.577350269189626;
+        for (int i = 0; i < plan->count; i++, t += FNL_PLAN_3D_TERMS)
+            out[i * stride] = _fnlGenNoiseTransformed3D(state, t[0] + (t[1] - zs), t[2] - zs, zs + t[3]);
+    }
+    break;
+    case _FNL_PLAN_IMPROVE_XZ:
+        for (int i = 0; i < plan->count; i++, t += FNL_PLAN_3D_TERMS)
+        {
+            FNLfloat xz = t[0] + zf;
+            FNLfloat s2 = xz * -(FNLfloat)0.211324865405187;
+            out[i * stride] = _fnlGenNoiseTransformed3D(state, t[0] + (s2 - t[1]), t[1] + xz * (FNLfloat)0.577350269189626, zf + (s2 - t[1]));
+        }
+        break;
+    }
+}
+
+void fnlGetNoisePlanDeriv3D(fnl_plan_3d *plan, FNLfloat z, float *out, float *dx, float *dy, float *dz, int stride)
+{
+    fnl_state *state = &plan->state;
+    const FNLfloat *t = plan->terms;
+    FNLfloat zf = z * state->frequency;
+    _fnl_plan_kind kind = _fnlPlanKind3D(state);
+    FNLfloat zs = zf * (FNLfloat)0.577350269189626;
+
+    for (int i = 0; i < plan->count; i++, t += FNL_PLAN_3D_TERMS)
+    {
+        FNLfloat xt, yt, zt;
+        switch (kind)
+        {
+        case _FNL_PLAN_SCALE:
+            xt = t[0];
+            yt = t[1];
+            zt = zf;
+            break;
+        case _FNL_PLAN_ROTATE:
+        {
+            FNLfloat r = (t[2] + zf) * (FNLfloat)(2.0 / 3.0); // Rotation, not skew
+            xt = r - t[0];
+            yt = r - t[1];
+            zt = r - zf;
+        }
+        break;
+        case _FNL_PLAN_IMPROVE_XY:
+            xt = t[0] + (t[1] - zs);
+            yt = t[2] - zs;
+            zt = zs + t[3];
+            break;
+        default:
+        {
+            FNLfloat xz = t[0] + zf;
+            FNLfloat s2 = xz * -(FNLfloat)0.211324865405187;
+            xt = t[0] + (s2 - t[1]);
+            yt = t[1] + xz * (FNLfloat)0.577350269189626;
+            zt = zf + (s2 - t[1]);
+        }
+        break;
+        }
+
+        float deriv[3];
+        out[i * stride] = _fnlGenNoiseTransformedDeriv3D(state, xt, yt, zt, deriv);
+        _fnlTransformNoiseGradient3D(state, deriv);
+        _fnlStoreDeriv3D(deriv, dx ? dx + i * stride : 0, dy ? dy + i * stride : 0, dz ? dz + i * stride : 0);
+    }
+}
+
+typedef struct _fnl_image_job
+{
+    fnl_state *state;
+    fnl_state *warp;
+    fnl_image *image;
+    int tile;
+    int tiles_x;
+    int tiles_y;
+    bool is_3d;
+} _fnl_image_job;
+
+static void _fnlGenNoiseImageTile(void *context, int index)
+{
+    _fnl_image_job *job = (_fnl_image_job *)context;
+    fnl_image *image = job->image;
+    int x0 = (index % job->tiles_x) * job->tile;
+    int y0 = (index / job->tiles_x % job->tiles_y) * job->tile;
+    int z0 = (index / job->tiles_x / job->tiles_y) * job->tile;
+    int x1 = x0 + job->tile < image->width ? x0 + job->tile : image->width;
+    int y1 = y0 + job->tile < image->height ? y0 + job->tile : image->height;
+    int z1 = !job->is_3d ? 1 : z0 + job->tile < image->depth ? z0 + job->tile : image->depth;
+
+    for (int k = z0; k < z1; k++)
+    {
+        for (int j = y0; j < y1; j++)
+        {
+            float *out = image->data + (k * image->height + j) * image->width;
+            for (int i = x0; i < x1; i++)
+            {
+                FNLfloat x = image->x + i * image->step_x;
+                FNLfloat y = image->y + j * image->step_y;
+                if (job->is_3d)
+                {
+                    FNLfloat z = image->z + k * image->step_z;
+                    if (job->warp)
+                        fnlDomainWarp3D(job->warp, &x, &y, &z);
+                    out[i] = fnlGetNoise3D(job->state, x, y, z);
+                }
+                else
+                {
+                    if (job->warp)
+                        fnlDomainWarp2D(job->warp, &x, &y);
+                    out[i] = fnlGetNoise2D(job->state, x, y);
+                }
+            }
+        }
+    }
+}
+
+static void _fnlGenNoiseImage(_fnl_image_job *job, const fnl_pool *pool)
+{
+    fnl_image *image = job->image;
+    job->tiles_x = (image->width + job->tile - 1) / job->tile;
+    job->tiles_y = (image->height + job->tile - 1) / job->tile;
+    int count = job->tiles_x * job->tiles_y * (job->is_3d ? (image->depth + job->tile - 1) / job->tile : 1);
+
+    if (pool)
+        pool->parallel_for(pool->pool, _fnlGenNoiseImageTile, job, count);
+    else
+        for (int i = 0; i < count; i++)
+            _fnlGenNoiseImageTile(job, i);
+}
+
+void fnlGenNoiseImage2D(fnl_state *state, fnl_state *warp, fnl_image *image, const fnl_pool *pool)
+{
+    _fnl_image_job job = {state, warp, image, FNL_IMAGE_TILE_2D, 0, 0, false};
+    _fnlGenNoiseImage(&job, pool);
+}
+
+void fnlGenNoiseImage3D(fnl_state *state, fnl_state *warp, fnl_image *image, const fnl_pool *pool)
+{
+    _fnl_image_job job = {state, warp, image, FNL_IMAGE_TILE_3D, 0, 0, true};
+    _fnlGenNoiseImage(&job, pool);
+}
+
 #endif // FNL_IMPL
 
 #if defined(__cplusplus)
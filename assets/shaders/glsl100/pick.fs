@@ -0,0 +1,25 @@
+#version 100
+
+// Packing 12 bit values needs more precision than mediump guarantees
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+varying vec2 fragTexCoord;
+varying vec3 viewPosition;
+
+uniform float pickId;
+// 0 to send the texture coordinates, otherwise the distance from the camera as a share of this
+uniform float pickRange;
+
+void main()
+{
+    vec2 value = pickRange > 0.0 ? vec2(length(viewPosition)/pickRange, 0.0) : fragTexCoord;
+    // Two 12 bit values across red, green and blue, with the id in alpha
+    vec2 bits = floor(clamp(value, 0.0, 1.0)*4095.0 + 0.5);
+    float xHigh = floor(bits.x/16.0);
+    float yHigh = floor(bits.y/256.0);
+    gl_FragColor = vec4(xHigh, (bits.x - xHigh*16.0)*16.0 + yHigh, bits.y - yHigh*256.0, pickId)/255.0;
+}
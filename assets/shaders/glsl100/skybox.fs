@@ -0,0 +1,13 @@
+#version 100
+
+precision mediump float;
+
+varying vec3 direction;
+
+uniform samplerCube environmentMap;
+uniform vec4 colDiffuse;
+
+void main()
+{
+    gl_FragColor = vec4(textureCube(environmentMap, direction).rgb, 1.0)*colDiffuse;
+}
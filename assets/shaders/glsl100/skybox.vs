@@ -0,0 +1,19 @@
+#version 100
+
+// Corners of a unit cube around the camera
+attribute vec3 vertexPosition;
+
+uniform mat4 matProjection;
+uniform mat4 matView;
+
+varying vec3 direction;
+
+void main()
+{
+    direction = vertexPosition;
+    // A w of 0 takes only the camera's rotation, so the sky never gets closer
+    vec4 view = matView*vec4(vertexPosition, 0.0);
+    vec4 clip = matProjection*vec4(view.xyz, 1.0);
+    // Depth 1 puts it on the far plane, behind everything already drawn
+    gl_Position = clip.xyww;
+}
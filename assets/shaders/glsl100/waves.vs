@@ -0,0 +1,23 @@
+#version 100
+
+// Lattice coordinates of the ring, displaced by the height map
+attribute vec3 vertexPosition;
+
+uniform mat4 mvp;
+uniform sampler2D heightMap;
+uniform vec2 ringOrigin;
+uniform float ringSpacing;
+uniform float ringSide;
+
+varying vec2 worldXZ;
+varying vec3 normal;
+
+void main()
+{
+    vec2 lattice = vertexPosition.xz;
+    // height, then its slope along x and z
+    vec3 wave = texture2D(heightMap, (lattice + 0.5)/ringSide).rgb;
+    worldXZ = ringOrigin + lattice*ringSpacing;
+    normal = normalize(vec3(-wave.g, 1.0, -wave.b));
+    gl_Position = mvp*vec4(worldXZ.x, wave.r, worldXZ.y, 1.0);
+}
@@ -0,0 +1,17 @@
+#version 100
+
+// World positions and normals, displaced on the CPU for GPUs that can't sample the height map
+attribute vec3 vertexPosition;
+attribute vec3 vertexNormal;
+
+uniform mat4 mvp;
+
+varying vec2 worldXZ;
+varying vec3 normal;
+
+void main()
+{
+    worldXZ = vertexPosition.xz;
+    normal = vertexNormal;
+    gl_Position = mvp*vec4(vertexPosition, 1.0);
+}
@@ -0,0 +1,20 @@
+#version 330
+
+in vec2 fragTexCoord;
+in vec3 viewPosition;
+
+uniform float pickId;
+// 0 to send the texture coordinates, otherwise the distance from the camera as a share of this
+uniform float pickRange;
+
+out vec4 finalColor;
+
+void main()
+{
+    vec2 value = pickRange > 0.0 ? vec2(length(viewPosition)/pickRange, 0.0) : fragTexCoord;
+    // Two 12 bit values across red, green and blue, with the id in alpha
+    vec2 bits = floor(clamp(value, 0.0, 1.0)*4095.0 + 0.5);
+    float xHigh = floor(bits.x/16.0);
+    float yHigh = floor(bits.y/256.0);
+    finalColor = vec4(xHigh, (bits.x - xHigh*16.0)*16.0 + yHigh, bits.y - yHigh*256.0, pickId)/255.0;
+}
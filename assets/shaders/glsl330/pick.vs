@@ -0,0 +1,18 @@
+#version 330
+
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+
+uniform mat4 mvp;
+uniform mat4 matModel;
+uniform mat4 matView;
+
+out vec2 fragTexCoord;
+out vec3 viewPosition;
+
+void main()
+{
+    fragTexCoord = vertexTexCoord;
+    viewPosition = (matView*matModel*vec4(vertexPosition, 1.0)).xyz;
+    gl_Position = mvp*vec4(vertexPosition, 1.0);
+}
@@ -0,0 +1,13 @@
+#version 330
+
+in vec3 direction;
+
+uniform samplerCube environmentMap;
+uniform vec4 colDiffuse;
+
+out vec4 finalColor;
+
+void main()
+{
+    finalColor = vec4(texture(environmentMap, direction).rgb, 1.0)*colDiffuse;
+}
@@ -0,0 +1,21 @@
+#version 330
+
+in vec2 worldXZ;
+in vec3 normal;
+
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+uniform float texPeriod;
+
+const vec3 sunDirection = vec3(0.36, 0.88, 0.31);
+
+out vec4 finalColor;
+
+void main()
+{
+    // Mirror the texture every period so neighbouring tiles meet without a seam
+    vec2 uv = 1.0 - abs(mod(worldXZ/texPeriod, 2.0) - 1.0);
+    // Flat water keeps the texture's own brightness, slopes facing away from the sun darken
+    float light = mix(0.6, 1.0, max(dot(normalize(normal), sunDirection), 0.0))/mix(0.6, 1.0, sunDirection.y);
+    finalColor = vec4(texture(texture0, uv).rgb*light, 1.0)*colDiffuse;
+}
@@ -0,0 +1,17 @@
+#version 330
+
+// World positions and normals, displaced on the CPU for GPUs that can't sample the height map
+in vec3 vertexPosition;
+in vec3 vertexNormal;
+
+uniform mat4 mvp;
+
+out vec2 worldXZ;
+out vec3 normal;
+
+void main()
+{
+    worldXZ = vertexPosition.xz;
+    normal = vertexNormal;
+    gl_Position = mvp*vec4(vertexPosition, 1.0);
+}
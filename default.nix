@@ -24,6 +24,7 @@ rec {
 
     cmakeFlags = prev.cmakeFlags ++ [
       "-DSUPPORT_FILEFORMAT_JPG=ON"
+      "-DSUPPORT_FILEFORMAT_KTX=ON"
       "-DCMAKE_BUILD_TYPE=Release"
     ];
 
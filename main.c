@@ -4,142 +4,3170 @@
 #include "rcamera.h"
 #define FNL_IMPL
 #include "FastNoiseLite.h"
+#include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 #include <math.h>
+#ifndef __EMSCRIPTEN__
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+#ifdef __EMSCRIPTEN__
+#include <GLES2/gl2.h> // for querying what WebGL 1 leaves optional
+#endif
+
+#define WAVE_SPAN 1024 // width of the outermost wave ring
+#define WAVE_LEVELS 5 // wave rings around the camera, each with twice the spacing of the one inside it
+#define WAVE_TEX_TILES 8
+#define WAVE_QUALITY -1 // index into waveQualities, or -1 to measure the hardware and pick one; --wave-quality=<name> overrides it
+#define WAVE_FRAME_BUDGET (1.0/60) // seconds a frame may take before the automatic wave quality steps down, or the refresh period if longer
+#define WAVE_SPECTRUM 0 // 1 to animate the waves from a wind spectrum with an FFT instead of noise
+#define WAVE_VERTEX_FETCH 1 // 0 to displace the wave meshes on the CPU instead of sampling height maps in the vertex shader; also off when the GPU can't
+#define WAVE_LOOP 0 // 1 to play back a looping animation baked from noise once the wave quality is settled, or loaded from a cache file; --wave-loop also turns it on; ignored on the web
+#define FFT_SIZE 256 // frequencies across the spectrum, must be a power of 2
+#define FFT_TILE 256.0f // width the FFT height field repeats over
+
+#ifndef RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES
+#define RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES 6
+#endif
+
+#ifdef __EMSCRIPTEN__
+#define GLSL_VERSION 100
+// WebGL 1 samples full floats in the vertex shader more reliably than halfs
+#define WAVE_HEIGHT_FORMAT PIXELFORMAT_UNCOMPRESSED_R32G32B32
+#else
+#define GLSL_VERSION 330
+#define WAVE_HEIGHT_FORMAT PIXELFORMAT_UNCOMPRESSED_R16G16B16
+#endif
+
+#define TEXTURE_MAX_SIZE 1024 // surface textures are shrunk to a power of 2 no larger than this; --texture-max-size=<n> overrides it
+#define NOISE_TEXTURE_SIZE 512 // size of the textures generated in place of noise-like jpgs, 0 to load the jpgs; --texture-size=<n> overrides it
+// textures written every frame rotate through this many copies so an upload never targets one still being drawn
+#define STREAM_FRAMES 3
+
+#define GPU_PICKING 0 // 1 to find what the crosshair or cursor is on by drawing ids into a one pixel target instead of raycasting; --gpu-picking also turns it on
+#define UNLOCK_ALL 0
+#define SHOW_FPS 0
+
+typedef enum { MODE_INTRO, MODE_FISHING, MODE_AWARD, MODE_GOFISH, MODE_JUKEBOX, MODE_CANVAS, MODE_PAINT } mode;
+
+typedef enum { STATE_POLE, STATE_WINDING, STATE_CASTING, STATE_CAST, STATE_HOOKED, STATE_REELING } state;
+
+typedef struct { char* file; char* display; } catch;
+
+// runs one job at a time off the main thread; without threads (web) jobs run inline on submit
+typedef struct {
+  void (*job)(void*);
+  void* arg;
+  bool busy;
+  bool quit;
+  #ifndef __EMSCRIPTEN__
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  #endif
+} worker;
+
+#ifndef __EMSCRIPTEN__
+void* workerLoop(void* arg) {
+  worker* w = (worker*)arg;
+  pthread_mutex_lock(&w->lock);
+  while (!w->quit) {
+    if (!w->busy) {
+      pthread_cond_wait(&w->wake, &w->lock);
+      continue;
+    }
+    pthread_mutex_unlock(&w->lock);
+    w->job(w->arg);
+    pthread_mutex_lock(&w->lock);
+    w->busy = false;
+    pthread_cond_broadcast(&w->wake);
+  }
+  pthread_mutex_unlock(&w->lock);
+  return NULL;
+}
+#endif
+
+void workerStart(worker* w) {
+  *w = (worker){ 0 };
+  #ifndef __EMSCRIPTEN__
+  pthread_mutex_init(&w->lock, NULL);
+  pthread_cond_init(&w->wake, NULL);
+  pthread_create(&w->thread, NULL, workerLoop, w);
+  #endif
+}
+
+// the caller must not touch the job's data again until workerWait returns
+void workerSubmit(worker* w, void (*job)(void*), void* arg) {
+  #ifndef __EMSCRIPTEN__
+  pthread_mutex_lock(&w->lock);
+  while (w->busy) pthread_cond_wait(&w->wake, &w->lock);
+  w->job = job;
+  w->arg = arg;
+  w->busy = true;
+  pthread_cond_broadcast(&w->wake);
+  pthread_mutex_unlock(&w->lock);
+  #else
+  job(arg);
+  #endif
+}
+
+bool workerBusy(worker* w) {
+  bool busy = false;
+  #ifndef __EMSCRIPTEN__
+  pthread_mutex_lock(&w->lock);
+  busy = w->busy;
+  pthread_mutex_unlock(&w->lock);
+  #endif
+  return busy;
+}
+
+void workerWait(worker* w) {
+  #ifndef __EMSCRIPTEN__
+  pthread_mutex_lock(&w->lock);
+  while (w->busy) pthread_cond_wait(&w->wake, &w->lock);
+  pthread_mutex_unlock(&w->lock);
+  #endif
+}
+
+void workerStop(worker* w) {
+  #ifndef __EMSCRIPTEN__
+  pthread_mutex_lock(&w->lock);
+  w->quit = true;
+  pthread_cond_broadcast(&w->wake);
+  pthread_mutex_unlock(&w->lock);
+  pthread_join(w->thread, NULL);
+  pthread_mutex_destroy(&w->lock);
+  pthread_cond_destroy(&w->wake);
+  #endif
+}
+
+// spreads the tiles of bulk noise jobs over a worker per extra core, with the calling thread taking tiles too
+typedef struct {
+  worker* workers;
+  int count;
+} threadPool;
+
+typedef struct {
+  void (*task)(void*, int);
+  void* context;
+  int count;
+  int next; // first task nobody has taken
+  #ifndef __EMSCRIPTEN__
+  pthread_mutex_t lock;
+  #endif
+} poolJob;
+
+threadPool loadThreadPool(void) {
+  threadPool pool = { 0 };
+  #ifndef __EMSCRIPTEN__
+  pool.count = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+  if (pool.count < 0) pool.count = 0;
+  #endif
+  pool.workers = (worker*)MemAlloc((pool.count + 1)*sizeof(worker));
+  for (int i = 0; i < pool.count; i++) workerStart(&pool.workers[i]);
+  return pool;
+}
+
+void unloadThreadPool(threadPool* pool) {
+  for (int i = 0; i < pool->count; i++) workerStop(&pool->workers[i]);
+  MemFree(pool->workers);
+}
+
+void poolJobRun(void* arg) {
+  poolJob* job = (poolJob*)arg;
+  while (true) {
+    #ifndef __EMSCRIPTEN__
+    pthread_mutex_lock(&job->lock);
+    #endif
+    int task = job->next++;
+    #ifndef __EMSCRIPTEN__
+    pthread_mutex_unlock(&job->lock);
+    #endif
+    if (task >= job->count) return;
+    job->task(job->context, task);
+  }
+}
+
+// fnl_pool.parallel_for; safe to call from several threads at once, the calls just share the workers
+void poolParallelFor(void* arg, void (*task)(void*, int), void* context, int count) {
+  threadPool* pool = (threadPool*)arg;
+  poolJob job = { task, context, count, 0 };
+  #ifndef __EMSCRIPTEN__
+  pthread_mutex_init(&job.lock, NULL);
+  #endif
+  for (int i = 0; i < pool->count && i < count - 1; i++) workerSubmit(&pool->workers[i], poolJobRun, &job);
+  poolJobRun(&job);
+  for (int i = 0; i < pool->count && i < count - 1; i++) workerWait(&pool->workers[i]);
+  #ifndef __EMSCRIPTEN__
+  pthread_mutex_destroy(&job.lock);
+  #endif
+}
+
+typedef struct {
+  Texture2D textures[STREAM_FRAMES];
+  int current;
+} textureStream;
+
+textureStream loadTextureStream(int width, int height, int format) {
+  textureStream s = { 0 };
+  for (int i = 0; i < STREAM_FRAMES; i++) {
+    s.textures[i] = (Texture2D){ rlLoadTexture(NULL, width, height, format, 1), width, height, 1, format };
+  }
+  return s;
+}
+
+void unloadTextureStream(textureStream* s) {
+  for (int i = 0; i < STREAM_FRAMES; i++) UnloadTexture(s->textures[i]);
+}
+
+void setTextureStreamFilter(textureStream* s, int filter, int wrap) {
+  for (int i = 0; i < STREAM_FRAMES; i++) {
+    SetTextureFilter(s->textures[i], filter);
+    SetTextureWrap(s->textures[i], wrap);
+  }
+}
+
+// uploads into the copy drawn longest ago and makes it current; draw with the returned texture
+Texture2D streamTexture(textureStream* s, const void* pixels) {
+  s->current = (s->current + 1) % STREAM_FRAMES;
+  UpdateTexture(s->textures[s->current], pixels);
+  return s->textures[s->current];
+}
+
+// the game advances in fixed ticks, drawing runs at whatever rate the display allows and interpolates between them
+#define TICK_RATE 60 // ticks per second
+#define TICK_SECONDS (1.0f/TICK_RATE)
+#define TICK_MAX 8 // ticks one frame may run, the rest of a longer frame is dropped so a stall can't snowball
+
+// how many ticks the frame's time covers, the remainder is kept towards the next frame
+int simulationTicks(float* accumulator, float frameTime) {
+  *accumulator += frameTime;
+  int ticks = (int)(*accumulator*TICK_RATE);
+  if (ticks > TICK_MAX) ticks = TICK_MAX;
+  *accumulator = ticks == TICK_MAX ? fmodf(*accumulator, TICK_SECONDS) : *accumulator - ticks*TICK_SECONDS;
+  return ticks;
+}
+
+// checked once a tick
+bool randomEvent(float avgSeconds) {
+  return GetRandomValue(1, (int)(128*avgSeconds*TICK_RATE)) <= 128;
+}
+
+// a wave sample is the height followed by its slope along x and z
+#define WAVE_SAMPLE 3
+
+void waveSample(fnl_state* noise, float x, float z, float t, float* sample) {
+  float dx, dz;
+  sample[0] = 5*fnlGetNoiseDeriv3D(noise, 2*x, 2*z, 30*t, &dx, &dz, NULL);
+  sample[1] = 10*dx;
+  sample[2] = 10*dz;
+}
+
+// the ocean is a stack of square rings centered on the camera (a geometry clipmap); ring 0 is a full grid and each ring
+// after it has twice the spacing and a hole where the previous ring sits
+
+typedef struct {
+  int peaks; // cells across the ring
+  int side; // vertices across the ring, peaks+1
+  float spacing;
+  int cx, cz; // center in units of spacing, always even so the ring's border lands on the next ring's vertices
+  double step; // seconds between keyframes
+  float* heights[3]; // keyframes of wave samples: previous, next, in progress
+  double times[3];
+  int centers[3][2]; // center each keyframe was computed for
+  bool started;
+  bool requested; // keyframe 2 is handed to the worker
+  bool ready; // keyframe 2 is done
+  fnl_plan_3d plan; // owned by whoever computes keyframes, matches planCenter
+  int planCenter[2];
+  FNLfloat* planTerms;
+  FNLfloat* planX;
+  FNLfloat* planZ;
+  float* surface; // drawn wave samples: interpolated keyframes with the border pinned to the next ring
+  textureStream heightMap; // surface as seen by the vertex shader, one wave sample per texel
+  struct waveField* fields[3]; // FFT height field each keyframe samples, when the ocean has a spectrum
+} waveRing;
+
+// the FFT ocean (Tessendorf): a Phillips spectrum is advanced in frequency space and brought back with an inverse FFT
+// into a height field that tiles every FFT_TILE units; rings sample it like they would sample noise
+#define FFT_FIELDS (3*WAVE_LEVELS) // enough for every keyframe of every ring to be at a different time
+#define FFT_FIELD_LEVELS WAVE_LEVELS // box filtered copies so coarse rings don't alias short waves
+
+typedef struct waveField {
+  double time;
+  bool valid;
+  float* levels[FFT_FIELD_LEVELS]; // wave samples, each level half the resolution of the last
+} waveField;
+
+typedef struct {
+  float* h0Re; // amplitude and phase of each frequency at time 0
+  float* h0Im;
+  float* omega; // angular speed of each frequency
+  float* re; // transform workspace, frequencies along x and z
+  float* im;
+  float* packRe; // second pass workspace, pairs of rows packed as real and imaginary parts
+  float* packIm;
+  float* twiddleRe; // e^(2 pi i k/FFT_SIZE) for k < FFT_SIZE/2
+  float* twiddleIm;
+  int* reverse; // bit reversed indices
+} waveSpectrum;
+
+// a looping animation baked from noise that tiles every FFT_TILE units, so it fills the same fields as the spectrum
+#define WAVE_LOOP_FRAMES 96
+#define WAVE_LOOP_SECONDS 12.0
+
+typedef struct {
+  fnl_state noise; // copy of the ocean's noise when the bake started
+  const fnl_pool* pool;
+  float* frames; // heights on the FFT grid, FFT_SIZE*FFT_SIZE per frame
+  char cachePath[512]; // empty when there's nowhere to cache it
+  worker baker; // idle once the frames are baked or loaded
+} waveLoop;
+
+// wave settings the ocean can switch between at runtime, cheapest first
+typedef struct {
+  const char* name;
+  int peaks; // cells across a wave ring, must be a multiple of 4
+  int keyframeRate; // keyframes per second in the innermost ring, halved for each ring after it; in-between frames are interpolated
+  int octaves; // fractal layers of noise; the noise stays OpenSimplex2, the only type with analytic slopes
+} waveQuality;
+
+const waveQuality waveQualities[] = {
+  { "low", 24, 8, 1 },
+  { "medium", 32, 12, 1 },
+  { "high", 48, 15, 1 },
+  { "ultra", 64, 20, 2 },
+};
+#define WAVE_QUALITIES (int)(sizeof(waveQualities)/sizeof(waveQualities[0]))
+#define WAVE_TUNE_SECONDS 2 // measuring time per quality when picking one automatically
+#define WAVE_TUNE_SETTLE 10 // frames skipped after switching quality, while the rings restart
+
+// what the waves cost over the current measuring window
+typedef struct {
+  double frameSeconds;
+  double updateSeconds; // main thread time in updateOcean
+  double waveSeconds; // time spent computing keyframes, on either thread
+  int frames;
+  int lateFrames; // frames that held a keyframe because the worker was behind
+} oceanStats;
+
+// each ring is a static lattice mesh displaced in the vertex shader, so only heights are uploaded per frame; without
+// vertex texture fetch the meshes get world positions and normals each frame instead
+typedef struct {
+  Model model; // one mesh per ring, finest first; vertex positions are lattice coordinates
+  waveRing rings[WAVE_LEVELS];
+  fnl_state* noise;
+  worker* worker;
+  waveSpectrum* spectrum; // NULL when the waves come from noise
+  waveLoop* loop; // NULL unless the waves are played back from a baked loop
+  bool loopWanted; // a loop is baked once the quality, and so the noise's octaves, is settled
+  const fnl_pool* pool; // for baking the loop
+  waveField* fields; // FFT_FIELDS fields the rings sample, NULL while they sample noise directly
+  float* scratch;
+  void* upload; // surface converted to the height map format
+  int ringOriginLoc;
+  int ringSpacingLoc;
+  int ringSideLoc;
+  bool vertexFetch; // false when the meshes are displaced on the CPU instead, and the rings have no height maps
+  int quality; // index into waveQualities
+  bool tuning; // still measuring qualities, from the best down
+  bool drawn; // drawOcean ran since the last tuneOcean
+  int settle; // frames left before measuring
+  oceanStats stats;
+  double jobSeconds; // written by oceanJob, read once the worker is idle
+} ocean;
+
+// IEEE half from float, flushing values too small for a normal half to zero
+unsigned short floatToHalf(float f) {
+  unsigned int x;
+  memcpy(&x, &f, sizeof(x));
+  unsigned int sign = (x >> 16) & 0x8000;
+  int exponent = (int)((x >> 23) & 0xff) - 127 + 15;
+  unsigned int mantissa = x & 0x7fffff;
+  if (exponent <= 0) return sign;
+  if (exponent >= 31) return sign | 0x7c00;
+  return sign | ((exponent << 10) + ((mantissa + 0x1000) >> 13));
+}
+
+float waveRingX(waveRing* ring, int cx, int i) {
+  return (cx - ring->peaks/2 + i)*ring->spacing;
+}
+
+waveField* loadWaveFields(void) {
+  waveField* fields = (waveField*)MemAlloc(FFT_FIELDS*sizeof(waveField));
+  for (int i = 0; i < FFT_FIELDS; i++) {
+    fields[i].time = -1;
+    for (int m = 0; m < FFT_FIELD_LEVELS; m++) {
+      int size = FFT_SIZE >> m;
+      fields[i].levels[m] = (float*)MemAlloc(size*size*WAVE_SAMPLE*sizeof(float));
+    }
+  }
+  return fields;
+}
+
+void unloadWaveFields(waveField* fields) {
+  for (int i = 0; i < FFT_FIELDS; i++) {
+    for (int m = 0; m < FFT_FIELD_LEVELS; m++) MemFree(fields[i].levels[m]);
+  }
+  MemFree(fields);
+}
+
+waveSpectrum* loadWaveSpectrum(int seed) {
+  waveSpectrum* s = (waveSpectrum*)MemAlloc(sizeof(waveSpectrum));
+  s->h0Re = (float*)MemAlloc(FFT_SIZE*FFT_SIZE*sizeof(float));
+  s->h0Im = (float*)MemAlloc(FFT_SIZE*FFT_SIZE*sizeof(float));
+  s->omega = (float*)MemAlloc(FFT_SIZE*FFT_SIZE*sizeof(float));
+  s->re = (float*)MemAlloc(FFT_SIZE*FFT_SIZE*sizeof(float));
+  s->im = (float*)MemAlloc(FFT_SIZE*FFT_SIZE*sizeof(float));
+  s->packRe = (float*)MemAlloc(FFT_SIZE*FFT_SIZE/2*sizeof(float));
+  s->packIm = (float*)MemAlloc(FFT_SIZE*FFT_SIZE/2*sizeof(float));
+  s->twiddleRe = (float*)MemAlloc(FFT_SIZE/2*sizeof(float));
+  s->twiddleIm = (float*)MemAlloc(FFT_SIZE/2*sizeof(float));
+  s->reverse = (int*)MemAlloc(FFT_SIZE*sizeof(int));
+  for (int k = 0; k < FFT_SIZE/2; k++) {
+    s->twiddleRe[k] = cosf(2*PI*k/FFT_SIZE);
+    s->twiddleIm[k] = sinf(2*PI*k/FFT_SIZE);
+  }
+  for (int i = 0; i < FFT_SIZE; i++) {
+    int r = 0;
+    for (int b = 1; b < FFT_SIZE; b <<= 1) r = (r << 1) | ((i/b) & 1);
+    s->reverse[i] = r;
+  }
+
+  const float gravity = 9.81f;
+  const float windSpeed = 12;
+  const Vector2 wind = Vector2Normalize((Vector2){ 1, 0.4f });
+  const float longest = windSpeed*windSpeed/gravity; // largest wave the wind can raise
+  const float shortest = 0.5f; // waves much shorter than this are damped
+  const float rms = 2.2f; // about the same as the noise waves
+
+  unsigned int rng = 2463534242u ^ (unsigned int)seed;
+  double energy = 0;
+  for (int j = 0, n = 0; j < FFT_SIZE; j++) {
+    for (int i = 0; i < FFT_SIZE; i++, n++) {
+      // the transform is unshifted, so the upper half of the indices are negative frequencies
+      float kx = 2*PI*(i < FFT_SIZE/2 ? i : i - FFT_SIZE)/FFT_TILE;
+      float kz = 2*PI*(j < FFT_SIZE/2 ? j : j - FFT_SIZE)/FFT_TILE;
+      float k2 = kx*kx + kz*kz;
+
+      // two gaussians by Box-Muller, drawn for every frequency so the spectrum only depends on the seed
+      float u[2];
+      for (int r = 0; r < 2; r++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        u[r] = (rng + 1.0f)/4294967296.0f;
+      }
+      float gauss = sqrtf(-2*logf(u[0]));
+      float gaussRe = gauss*cosf(2*PI*u[1]);
+      float gaussIm = gauss*sinf(2*PI*u[1]);
+
+      if (k2 == 0) continue;
+      float along = (kx*wind.x + kz*wind.y)*(kx*wind.x + kz*wind.y)/k2;
+      float phillips = expf(-1/(k2*longest*longest))/(k2*k2)*along*expf(-k2*shortest*shortest);
+      if (kx*wind.x + kz*wind.y < 0) phillips *= 0.07f; // little travels against the wind
+      s->h0Re[n] = gaussRe*sqrtf(phillips/2);
+      s->h0Im[n] = gaussIm*sqrtf(phillips/2);
+      s->omega[n] = sqrtf(gravity*sqrtf(k2));
+      energy += s->h0Re[n]*s->h0Re[n] + s->h0Im[n]*s->h0Im[n];
+    }
+  }
+
+  // each height is the sum of every frequency and its mirror, so the mean square height is twice the energy
+  float scale = energy > 0 ? rms/(float)sqrt(2*energy) : 0;
+  for (int n = 0; n < FFT_SIZE*FFT_SIZE; n++) {
+    s->h0Re[n] *= scale;
+    s->h0Im[n] *= scale;
+  }
+
+  return s;
+}
+
+void unloadWaveSpectrum(waveSpectrum* s) {
+  MemFree(s->h0Re);
+  MemFree(s->h0Im);
+  MemFree(s->omega);
+  MemFree(s->re);
+  MemFree(s->im);
+  MemFree(s->packRe);
+  MemFree(s->packIm);
+  MemFree(s->twiddleRe);
+  MemFree(s->twiddleIm);
+  MemFree(s->reverse);
+  MemFree(s);
+}
+
+// inverse transform down the first `width` columns at once, so the butterflies run along contiguous rows and vectorize
+void fftColumns(waveSpectrum* s, float* re, float* im, int width, int stride) {
+  for (int j = 0; j < FFT_SIZE; j++) {
+    int r = s->reverse[j];
+    if (r <= j) continue;
+    for (int i = 0; i < width; i++) {
+      float t = re[j*stride + i]; re[j*stride + i] = re[r*stride + i]; re[r*stride + i] = t;
+      t = im[j*stride + i]; im[j*stride + i] = im[r*stride + i]; im[r*stride + i] = t;
+    }
+  }
+
+  for (int size = 2; size <= FFT_SIZE; size *= 2) {
+    int half = size/2;
+    int step = FFT_SIZE/size;
+    for (int start = 0; start < FFT_SIZE; start += size) {
+      for (int k = 0; k < half; k++) {
+        float wr = s->twiddleRe[k*step];
+        float wi = s->twiddleIm[k*step];
+        float* restrict ar = re + (start + k)*stride;
+        float* restrict ai = im + (start + k)*stride;
+        float* restrict br = ar + half*stride;
+        float* restrict bi = ai + half*stride;
+        for (int i = 0; i < width; i++) {
+          float tr = wr*br[i] - wi*bi[i];
+          float ti = wr*bi[i] + wi*br[i];
+          br[i] = ar[i] - tr;
+          bi[i] = ai[i] - ti;
+          ar[i] += tr;
+          ai[i] += ti;
+        }
+      }
+    }
+  }
+}
+
+// fills in the coarser levels and the slopes of a field whose finest heights are set
+void finishWaveField(waveField* f) {
+  for (int m = 1; m < FFT_FIELD_LEVELS; m++) {
+    int size = FFT_SIZE >> m;
+    const float* fine = f->levels[m-1];
+    float* coarse = f->levels[m];
+    for (int j = 0; j < size; j++) {
+      for (int i = 0; i < size; i++) {
+        const float* p = fine + WAVE_SAMPLE*(2*j*2*size + 2*i);
+        coarse[WAVE_SAMPLE*(j*size + i)] = (p[0] + p[WAVE_SAMPLE] + p[WAVE_SAMPLE*2*size] + p[WAVE_SAMPLE*(2*size + 1)])/4;
+      }
+    }
+  }
+
+  // slopes by central differences, which is exact enough for a field this smooth
+  for (int m = 0; m < FFT_FIELD_LEVELS; m++) {
+    int size = FFT_SIZE >> m;
+    float cell = FFT_TILE/size;
+    float* h = f->levels[m];
+    for (int j = 0; j < size; j++) {
+      for (int i = 0; i < size; i++) {
+        float* sample = h + WAVE_SAMPLE*(j*size + i);
+        sample[1] = (h[WAVE_SAMPLE*(j*size + ((i + 1) & (size-1)))] - h[WAVE_SAMPLE*(j*size + ((i - 1) & (size-1)))])/(2*cell);
+        sample[2] = (h[WAVE_SAMPLE*(((j + 1) & (size-1))*size + i)] - h[WAVE_SAMPLE*(((j - 1) & (size-1))*size + i)])/(2*cell);
+      }
+    }
+  }
+  f->valid = true;
+}
+
+// the heights are real, so the spectrum mirrors itself: only the non-negative x frequencies are advanced and transformed
+// along z, and the x pass transforms two rows of heights at once as the real and imaginary parts of one signal
+void computeWaveField(waveSpectrum* s, waveField* f) {
+  const int width = FFT_SIZE/2 + 1;
+  for (int j = 0; j < FFT_SIZE; j++) {
+    for (int i = 0; i < width; i++) {
+      // h0(k) e^(i omega t) + conj(h0(-k)) e^(-i omega t)
+      int n = j*FFT_SIZE + i;
+      int m = ((FFT_SIZE - j) & (FFT_SIZE-1))*FFT_SIZE + ((FFT_SIZE - i) & (FFT_SIZE-1));
+      double cycles = s->omega[n]*f->time/(2*PI);
+      float phase = 2*PI*(float)(cycles - floor(cycles));
+      float c = cosf(phase), sn = sinf(phase);
+      s->re[n] = (s->h0Re[n] + s->h0Re[m])*c - (s->h0Im[n] + s->h0Im[m])*sn;
+      s->im[n] = (s->h0Re[n] - s->h0Re[m])*sn + (s->h0Im[n] - s->h0Im[m])*c;
+    }
+  }
+  fftColumns(s, s->re, s->im, width, FFT_SIZE);
+
+  // transpose into row pairs, filling in the negative x frequencies as conjugates
+  for (int kx = 0; kx < FFT_SIZE; kx++) {
+    int i = kx < width ? kx : FFT_SIZE - kx;
+    float sign = kx < width ? 1 : -1;
+    for (int z = 0; z < FFT_SIZE/2; z++) {
+      const int a = 2*z*FFT_SIZE + i, b = a + FFT_SIZE;
+      s->packRe[kx*FFT_SIZE/2 + z] = s->re[a] - sign*s->im[b];
+      s->packIm[kx*FFT_SIZE/2 + z] = sign*s->im[a] + s->re[b];
+    }
+  }
+  fftColumns(s, s->packRe, s->packIm, FFT_SIZE/2, FFT_SIZE/2);
+
+  float* samples = f->levels[0];
+  for (int z = 0; z < FFT_SIZE/2; z++) {
+    for (int x = 0; x < FFT_SIZE; x++) {
+      samples[WAVE_SAMPLE*(2*z*FFT_SIZE + x)] = s->packRe[x*FFT_SIZE/2 + z];
+      samples[WAVE_SAMPLE*((2*z + 1)*FFT_SIZE + x)] = s->packIm[x*FFT_SIZE/2 + z];
+    }
+  }
+  finishWaveField(f);
+}
+
+// the coarsest level whose cells are no wider than the spacing it's sampled at
+int waveFieldLevel(float spacing) {
+  int level = 0;
+  while (level < FFT_FIELD_LEVELS-1 && FFT_TILE/(FFT_SIZE >> (level+1)) <= spacing) level++;
+  return level;
+}
+
+void sampleWaveField(const waveField* f, int level, float x, float z, float* sample) {
+  int size = FFT_SIZE >> level;
+  float fx = x*size/FFT_TILE;
+  float fz = z*size/FFT_TILE;
+  float x0 = floorf(fx), z0 = floorf(fz);
+  fx -= x0;
+  fz -= z0;
+  int i0 = (int)x0 & (size-1), i1 = (i0 + 1) & (size-1);
+  int j0 = (int)z0 & (size-1), j1 = (j0 + 1) & (size-1);
+  const float* h00 = f->levels[level] + WAVE_SAMPLE*(j0*size + i0);
+  const float* h10 = f->levels[level] + WAVE_SAMPLE*(j0*size + i1);
+  const float* h01 = f->levels[level] + WAVE_SAMPLE*(j1*size + i0);
+  const float* h11 = f->levels[level] + WAVE_SAMPLE*(j1*size + i1);
+  for (int c = 0; c < WAVE_SAMPLE; c++) {
+    float a = h00[c] + fx*(h10[c] - h00[c]);
+    float b = h01[c] + fx*(h11[c] - h01[c]);
+    sample[c] = a + fz*(b - a);
+  }
+}
+
+// a field for the given time, shared with any keyframe already at that time; only called while the worker is idle
+waveField* acquireWaveField(ocean* o, double time) {
+  waveField* fields = o->fields;
+  bool used[FFT_FIELDS] = { 0 };
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    for (int k = 0; k < 3; k++) {
+      if (o->rings[l].fields[k] != NULL) used[o->rings[l].fields[k] - fields] = true;
+    }
+  }
+
+  for (int i = 0; i < FFT_FIELDS; i++) {
+    if (fields[i].time == time && (fields[i].valid || used[i])) return &fields[i];
+  }
+
+  waveField* oldest = NULL;
+  for (int i = 0; i < FFT_FIELDS; i++) {
+    if (!used[i] && (oldest == NULL || fields[i].time < oldest->time)) oldest = &fields[i];
+  }
+  oldest->time = time;
+  oldest->valid = false;
+  return oldest;
+}
+
+// weight of the field (c = 0) or its copy shifted back one period (c = 1) at s along the period; the two cross fade
+// so each end matches the other, keeping the variance of independent fields so the middle doesn't flatten out
+float waveLoopWeight(float s, int c) {
+  return (c == 0 ? 1 - s : s)/sqrtf(s*s + (1 - s)*(1 - s));
+}
+
+// bakes the loop by blending eight copies of the noise offset by one period in x, z and time, or loads it from the cache
+void bakeWaveLoop(void* arg) {
+  waveLoop* loop = (waveLoop*)arg;
+  const int count = FFT_SIZE*FFT_SIZE;
+  const int size = count*WAVE_LOOP_FRAMES*sizeof(float);
+  if (loop->cachePath[0] != '\0' && FileExists(loop->cachePath)) {
+    int cachedSize = 0;
+    unsigned char* cached = LoadFileData(loop->cachePath, &cachedSize);
+    if (cached != NULL && cachedSize == size) memcpy(loop->frames, cached, size);
+    UnloadFileData(cached);
+    if (cachedSize == size) return;
+  }
+
+  float* weights = (float*)MemAlloc(count*sizeof(float));
+  float* heights = (float*)MemAlloc(count*sizeof(float));
+  memset(loop->frames, 0, size);
+  for (int b = 0; b < 2; b++) {
+    for (int a = 0; a < 2; a++) {
+      for (int j = 0, n = 0; j < FFT_SIZE; j++) {
+        for (int i = 0; i < FFT_SIZE; i++, n++) {
+          weights[n] = waveLoopWeight((float)i/FFT_SIZE, a)*waveLoopWeight((float)j/FFT_SIZE, b);
+        }
+      }
+      for (int f = 0; f < WAVE_LOOP_FRAMES; f++) {
+        float* frame = loop->frames + f*count;
+        for (int c = 0; c < 2; c++) {
+          // same inputs as waveSample
+          double t = (double)f/WAVE_LOOP_FRAMES*WAVE_LOOP_SECONDS - c*WAVE_LOOP_SECONDS;
+          fnl_image image = { heights, FFT_SIZE, FFT_SIZE, 1, -2*a*FFT_TILE, -2*b*FFT_TILE, 30*(FNLfloat)t, 2*FFT_TILE/FFT_SIZE, 2*FFT_TILE/FFT_SIZE, 0 };
+          fnlGenNoiseImage3D(&loop->noise, NULL, &image, loop->pool);
+          float w = 5*waveLoopWeight((float)f/WAVE_LOOP_FRAMES, c);
+          for (int n = 0; n < count; n++) frame[n] += w*weights[n]*heights[n];
+        }
+      }
+    }
+  }
+  MemFree(weights);
+  MemFree(heights);
+
+  if (loop->cachePath[0] != '\0') SaveFileData(loop->cachePath, loop->frames, size);
+}
+
+// where files the game can always rebuild are kept, created if needed: the user's cache directory, or a cache directory
+// next to the executable when there's none; NULL when it can't be created
+const char* cacheDirectory(void) {
+  static char directory[512] = { 0 };
+  if (directory[0] != '\0') return directory;
+  const char* xdg = getenv("XDG_CACHE_HOME");
+  const char* local = getenv("LOCALAPPDATA");
+  const char* home = getenv("HOME");
+  if (xdg != NULL && xdg[0] != '\0') snprintf(directory, sizeof(directory), "%s/amigalite-ark", xdg);
+  else if (local != NULL && local[0] != '\0') snprintf(directory, sizeof(directory), "%s/amigalite-ark", local);
+  else if (home != NULL && home[0] != '\0') snprintf(directory, sizeof(directory), "%s/.cache/amigalite-ark", home);
+  else snprintf(directory, sizeof(directory), "%scache", GetApplicationDirectory());
+  if (!DirectoryExists(directory) && MakeDirectory(directory) != 0) {
+    TraceLog(LOG_WARNING, "CACHE: could not create %s", directory);
+    directory[0] = '\0';
+    return NULL;
+  }
+  return directory;
+}
+
+// deletes loops cached for other settings, so only the one in use is kept on disk
+void removeStaleWaveLoops(const char* keep) {
+  FilePathList files = LoadDirectoryFiles(GetDirectoryPath(keep));
+  for (unsigned int i = 0; i < files.count; i++) {
+    const char* name = GetFileName(files.paths[i]);
+    if (strncmp(name, "waves-", 6) == 0 && IsFileExtension(name, ".loop") && strcmp(name, GetFileName(keep)) != 0) {
+      remove(files.paths[i]);
+    }
+  }
+  UnloadDirectoryFiles(files);
+}
+
+// starts baking (or loading) a loop of the given noise in the background
+waveLoop* loadWaveLoop(const fnl_state* noise, const fnl_pool* pool) {
+  waveLoop* loop = (waveLoop*)MemAlloc(sizeof(waveLoop));
+  loop->noise = *noise;
+  loop->pool = pool;
+  loop->frames = (float*)MemAlloc(FFT_SIZE*FFT_SIZE*WAVE_LOOP_FRAMES*sizeof(float));
+
+  // FNV-1a over everything the frames depend on, so a stale cache is never picked up
+  const int ints[] = { noise->seed, noise->noise_type, noise->rotation_type_3d, noise->fractal_type, noise->octaves, FFT_SIZE, WAVE_LOOP_FRAMES };
+  const float floats[] = { noise->frequency, noise->lacunarity, noise->gain, noise->weighted_strength, FFT_TILE, (float)WAVE_LOOP_SECONDS };
+  unsigned int key = 2166136261u;
+  for (int i = 0; i < (int)sizeof(ints); i++) key = (key ^ ((const unsigned char*)ints)[i])*16777619u;
+  for (int i = 0; i < (int)sizeof(floats); i++) key = (key ^ ((const unsigned char*)floats)[i])*16777619u;
+  const char* directory = cacheDirectory();
+  if (directory != NULL) {
+    snprintf(loop->cachePath, sizeof(loop->cachePath), "%s/waves-%08x.loop", directory, key);
+    removeStaleWaveLoops(loop->cachePath);
+  }
+
+  workerStart(&loop->baker);
+  workerSubmit(&loop->baker, bakeWaveLoop, loop);
+  return loop;
+}
+
+void unloadWaveLoop(waveLoop* loop) {
+  workerStop(&loop->baker);
+  MemFree(loop->frames);
+  MemFree(loop);
+}
+
+void computeLoopField(waveLoop* loop, waveField* f) {
+  double frames = fmod(f->time, WAVE_LOOP_SECONDS)/WAVE_LOOP_SECONDS*WAVE_LOOP_FRAMES;
+  int f0 = (int)frames % WAVE_LOOP_FRAMES;
+  float alpha = (float)(frames - floor(frames));
+  const float* a = loop->frames + f0*FFT_SIZE*FFT_SIZE;
+  const float* b = loop->frames + ((f0 + 1) % WAVE_LOOP_FRAMES)*FFT_SIZE*FFT_SIZE;
+  for (int n = 0; n < FFT_SIZE*FFT_SIZE; n++) f->levels[0][WAVE_SAMPLE*n] = a[n] + alpha*(b[n] - a[n]);
+  finishWaveField(f);
+}
+
+void planWaveRing(waveRing* ring, fnl_state* noise, int cx, int cz) {
+  for (int j = 0, n = 0; j < ring->side; j++) {
+    for (int i = 0; i < ring->side; i++, n++) {
+      // same inputs as waveSample
+      ring->planX[n] = 2*waveRingX(ring, cx, i);
+      ring->planZ[n] = 2*waveRingX(ring, cz, j);
+    }
+  }
+  ring->plan = fnlCreatePlan3D(noise, ring->planX, ring->planZ, ring->side*ring->side, ring->planTerms);
+  ring->planCenter[0] = cx;
+  ring->planCenter[1] = cz;
+}
+
+void computeWaveKeyframe(ocean* o, waveRing* ring) {
+  if (o->fields != NULL) {
+    waveField* f = ring->fields[2];
+    if (!f->valid && o->spectrum != NULL) computeWaveField(o->spectrum, f);
+    else if (!f->valid) computeLoopField(o->loop, f);
+    int level = waveFieldLevel(ring->spacing);
+    for (int j = 0, n = 0; j < ring->side; j++) {
+      for (int i = 0; i < ring->side; i++, n++) {
+        sampleWaveField(f, level, waveRingX(ring, ring->centers[2][0], i), waveRingX(ring, ring->centers[2][1], j), &ring->heights[2][WAVE_SAMPLE*n]);
+      }
+    }
+    return;
+  }
+
+  if (ring->planCenter[0] != ring->centers[2][0] || ring->planCenter[1] != ring->centers[2][1]) {
+    planWaveRing(ring, o->noise, ring->centers[2][0], ring->centers[2][1]);
+  }
+  float* h = ring->heights[2];
+  fnlGetNoisePlanDeriv3D(&ring->plan, 30*(FNLfloat)ring->times[2], h, h+1, h+2, NULL, WAVE_SAMPLE);
+  for (int i = 0; i < ring->side*ring->side*WAVE_SAMPLE; i += WAVE_SAMPLE) {
+    h[i] *= 5;
+    h[i+1] *= 10;
+    h[i+2] *= 10;
+  }
+}
+
+void oceanJob(void* arg) {
+  ocean* o = (ocean*)arg;
+  double start = GetTime();
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    if (o->rings[l].requested) computeWaveKeyframe(o, &o->rings[l]);
+  }
+  o->jobSeconds = GetTime() - start;
+}
+
+void rotateWaveKeyframes(waveRing* ring) {
+  float* oldest = ring->heights[0];
+  ring->heights[0] = ring->heights[1];
+  ring->heights[1] = ring->heights[2];
+  ring->heights[2] = oldest;
+  ring->times[0] = ring->times[1];
+  ring->times[1] = ring->times[2];
+  memcpy(ring->centers[0], ring->centers[1], sizeof(ring->centers[0]));
+  memcpy(ring->centers[1], ring->centers[2], sizeof(ring->centers[0]));
+  ring->fields[0] = ring->fields[1];
+  ring->fields[1] = ring->fields[2];
+  ring->fields[2] = NULL;
+}
+
+// sets up keyframe 2 at the ring's current center; only called while the worker is idle
+void requestWaveKeyframe(ocean* o, waveRing* ring, double time) {
+  ring->times[2] = time;
+  ring->centers[2][0] = ring->cx;
+  ring->centers[2][1] = ring->cz;
+  if (o->fields != NULL) {
+    ring->fields[2] = NULL;
+    ring->fields[2] = acquireWaveField(o, time);
+  }
+}
+
+void waveKeyframeSample(ocean* o, waveRing* ring, int k, float x, float z, float* sample) {
+  if (o->fields != NULL) sampleWaveField(ring->fields[k], waveFieldLevel(ring->spacing), x, z, sample);
+  else waveSample(o->noise, x, z, (float)ring->times[k], sample);
+}
+
+// moves a keyframe to the ring's current center, keeping the overlap and evaluating the newly exposed vertices
+void rebaseWaveKeyframe(ocean* o, waveRing* ring, int k) {
+  int dx = ring->cx - ring->centers[k][0];
+  int dz = ring->cz - ring->centers[k][1];
+  if (dx == 0 && dz == 0) return;
+
+  for (int j = 0, n = 0; j < ring->side; j++) {
+    for (int i = 0; i < ring->side; i++, n++) {
+      int oi = i + dx;
+      int oj = j + dz;
+      if (oi >= 0 && oi < ring->side && oj >= 0 && oj < ring->side) {
+        memcpy(&o->scratch[WAVE_SAMPLE*n], &ring->heights[k][WAVE_SAMPLE*(oj*ring->side + oi)], WAVE_SAMPLE*sizeof(float));
+      } else {
+        waveKeyframeSample(o, ring, k, waveRingX(ring, ring->cx, i), waveRingX(ring, ring->cz, j), &o->scratch[WAVE_SAMPLE*n]);
+      }
+    }
+  }
+
+  float* rebased = o->scratch;
+  o->scratch = ring->heights[k];
+  ring->heights[k] = rebased;
+  ring->centers[k][0] = ring->cx;
+  ring->centers[k][1] = ring->cz;
+}
+
+// triangulates every cell of the ring that the finer ring inside it does not cover
+void indexWaveRing(ocean* o, int level) {
+  waveRing* ring = &o->rings[level];
+  Mesh* mesh = &o->model.meshes[level];
+
+  int holeMinX = 0, holeMaxX = 0, holeMinZ = 0, holeMaxZ = 0;
+  if (level > 0) {
+    waveRing* inner = &o->rings[level-1];
+    holeMinX = (inner->cx - ring->peaks/2)/2 - (ring->cx - ring->peaks/2);
+    holeMaxX = (inner->cx + ring->peaks/2)/2 - (ring->cx - ring->peaks/2);
+    holeMinZ = (inner->cz - ring->peaks/2)/2 - (ring->cz - ring->peaks/2);
+    holeMaxZ = (inner->cz + ring->peaks/2)/2 - (ring->cz - ring->peaks/2);
+  }
+
+  int n = 0;
+  for (int j = 0; j < ring->peaks; j++) {
+    for (int i = 0; i < ring->peaks; i++) {
+      if (i >= holeMinX && i < holeMaxX && j >= holeMinZ && j < holeMaxZ) continue;
+      unsigned short v00 = j*ring->side + i;
+      unsigned short v10 = v00 + 1;
+      unsigned short v01 = v00 + ring->side;
+      unsigned short v11 = v01 + 1;
+      mesh->indices[n++] = v00; mesh->indices[n++] = v01; mesh->indices[n++] = v11;
+      mesh->indices[n++] = v00; mesh->indices[n++] = v11; mesh->indices[n++] = v10;
+    }
+  }
+  mesh->triangleCount = n/3;
+
+  if (mesh->vboId != NULL) {
+    rlUpdateVertexBufferElements(mesh->vboId[RL_DEFAULT_SHADER_ATTRIB_LOCATION_INDICES], mesh->indices, n*sizeof(unsigned short), 0);
+  }
+}
+
+// allocates the rings, their meshes and height maps for the ocean's quality; they start over on the next update
+void loadWaveRings(ocean* o) {
+  const waveQuality* quality = &waveQualities[o->quality];
+  int side = quality->peaks + 1;
+  o->noise->fractal_type = quality->octaves > 1 ? FNL_FRACTAL_FBM : FNL_FRACTAL_NONE;
+  o->noise->octaves = quality->octaves;
+  o->scratch = (float*)MemAlloc(side*side*WAVE_SAMPLE*sizeof(float));
+  o->upload = MemAlloc(side*side*WAVE_SAMPLE*sizeof(float));
+  float ringSide = (float)side;
+  SetShaderValue(o->model.materials[0].shader, o->ringSideLoc, &ringSide, SHADER_UNIFORM_FLOAT);
+
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    waveRing* ring = &o->rings[l];
+    *ring = (waveRing){ 0 };
+    ring->peaks = quality->peaks;
+    ring->side = side;
+    ring->spacing = (float)WAVE_SPAN/(ring->peaks << (WAVE_LEVELS-1-l));
+    ring->step = (double)(1 << l)/quality->keyframeRate;
+    for (int k = 0; k < 3; k++) ring->heights[k] = (float*)MemAlloc(side*side*WAVE_SAMPLE*sizeof(float));
+    ring->planTerms = (FNLfloat*)MemAlloc(side*side*FNL_PLAN_3D_TERMS*sizeof(FNLfloat));
+    ring->planX = (FNLfloat*)MemAlloc(side*side*sizeof(FNLfloat));
+    ring->planZ = (FNLfloat*)MemAlloc(side*side*sizeof(FNLfloat));
+    planWaveRing(ring, o->noise, 0, 0);
+    ring->surface = (float*)MemAlloc(side*side*WAVE_SAMPLE*sizeof(float));
+
+    if (o->vertexFetch) {
+      ring->heightMap = loadTextureStream(side, side, WAVE_HEIGHT_FORMAT);
+      setTextureStreamFilter(&ring->heightMap, TEXTURE_FILTER_POINT, TEXTURE_WRAP_CLAMP);
+    }
+
+    Mesh* mesh = &o->model.meshes[l];
+    *mesh = (Mesh){ 0 };
+    mesh->vertexCount = side*side;
+    mesh->vertices = (float*)MemAlloc(side*side*3*sizeof(float));
+    for (int j = 0, n = 0; j < side; j++) {
+      for (int i = 0; i < side; i++, n++) {
+        mesh->vertices[3*n] = (float)i;
+        mesh->vertices[3*n+2] = (float)j;
+      }
+    }
+    if (!o->vertexFetch) mesh->normals = (float*)MemAlloc(side*side*3*sizeof(float));
+    mesh->indices = (unsigned short*)MemAlloc(ring->peaks*ring->peaks*6*sizeof(unsigned short));
+  }
+
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    Mesh* mesh = &o->model.meshes[l];
+    // size the index buffer for a ring without a hole so it never has to grow
+    mesh->triangleCount = quality->peaks*quality->peaks*2;
+    UploadMesh(mesh, true);
+    indexWaveRing(o, l);
+  }
+}
+
+void unloadWaveRings(ocean* o) {
+  workerWait(o->worker);
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    waveRing* ring = &o->rings[l];
+    for (int k = 0; k < 3; k++) MemFree(ring->heights[k]);
+    MemFree(ring->planTerms);
+    MemFree(ring->planX);
+    MemFree(ring->planZ);
+    MemFree(ring->surface);
+    if (o->vertexFetch) unloadTextureStream(&ring->heightMap);
+    UnloadMesh(o->model.meshes[l]);
+    o->model.meshes[l] = (Mesh){ 0 };
+  }
+  MemFree(o->scratch);
+  MemFree(o->upload);
+}
+
+// whether the vertex shader can sample the height maps; WebGL 1 may have no vertex texture units or no float textures,
+// and the waves would draw flat without a word
+bool waveVertexFetchSupported(void) {
+  #ifdef __EMSCRIPTEN__
+  GLint units = 0;
+  glGetIntegerv(GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS, &units);
+  const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+  bool floats = extensions != NULL && strstr(extensions, "OES_texture_float") != NULL;
+  if (units > 0 && floats) return true;
+  TraceLog(LOG_WARNING, "WAVES: %i vertex texture units, float textures %s; displacing on the CPU", units, floats ? "supported" : "unsupported");
+  return false;
+  #else
+  return true; // both are core in OpenGL 3.3
+  #endif
+}
+
+// writes a ring's surface into its mesh as world positions and normals, for when the vertex shader can't sample it
+void displaceWaveRing(ocean* o, int level) {
+  waveRing* ring = &o->rings[level];
+  Mesh* mesh = &o->model.meshes[level];
+  for (int j = 0, n = 0; j < ring->side; j++) {
+    for (int i = 0; i < ring->side; i++, n++) {
+      const float* sample = &ring->surface[WAVE_SAMPLE*n];
+      Vector3 normal = Vector3Normalize((Vector3){ -sample[1], 1, -sample[2] });
+      mesh->vertices[3*n] = waveRingX(ring, ring->cx, i);
+      mesh->vertices[3*n+1] = sample[0];
+      mesh->vertices[3*n+2] = waveRingX(ring, ring->cz, j);
+      mesh->normals[3*n] = normal.x;
+      mesh->normals[3*n+1] = normal.y;
+      mesh->normals[3*n+2] = normal.z;
+    }
+  }
+  UpdateMeshBuffer(*mesh, SHADER_LOC_VERTEX_POSITION, mesh->vertices, mesh->vertexCount*3*sizeof(float), 0);
+  UpdateMeshBuffer(*mesh, SHADER_LOC_VERTEX_NORMAL, mesh->normals, mesh->vertexCount*3*sizeof(float), 0);
+}
+
+// quality is an index into waveQualities, or -1 to start from the best one and step down while the frame budget is missed;
+// a loop takes noise directly until the quality is settled and it's baked from that quality's noise, and is ignored with
+// a spectrum
+ocean loadOcean(fnl_state* noise, worker* worker, const fnl_pool* pool, bool spectrum, bool loop, int quality) {
+  ocean o = { 0 };
+  o.noise = noise;
+  o.worker = worker;
+  if (spectrum) {
+    o.spectrum = loadWaveSpectrum(noise->seed);
+    o.fields = loadWaveFields();
+  }
+  o.tuning = quality < 0;
+  o.quality = o.tuning ? WAVE_QUALITIES-1 : quality;
+  o.settle = WAVE_TUNE_SETTLE;
+  o.vertexFetch = WAVE_VERTEX_FETCH && waveVertexFetchSupported();
+
+  const char* vertexShader = o.vertexFetch ? "waves.vs" : "waves_mesh.vs";
+  Shader shader = LoadShader(TextFormat("assets/shaders/glsl%i/%s", GLSL_VERSION, vertexShader), TextFormat("assets/shaders/glsl%i/waves.fs", GLSL_VERSION));
+  shader.locs[SHADER_LOC_MAP_HEIGHT] = GetShaderLocation(shader, "heightMap");
+  o.ringOriginLoc = GetShaderLocation(shader, "ringOrigin");
+  o.ringSpacingLoc = GetShaderLocation(shader, "ringSpacing");
+  o.ringSideLoc = GetShaderLocation(shader, "ringSide");
+  float texPeriod = (float)WAVE_SPAN/WAVE_TEX_TILES;
+  SetShaderValue(shader, GetShaderLocation(shader, "texPeriod"), &texPeriod, SHADER_UNIFORM_FLOAT);
+
+  o.model.transform = MatrixTranslate(0, -13, 0);
+  o.model.meshCount = WAVE_LEVELS;
+  o.model.meshes = (Mesh*)MemAlloc(WAVE_LEVELS*sizeof(Mesh));
+  o.model.materialCount = 1;
+  o.model.materials = (Material*)MemAlloc(sizeof(Material));
+  o.model.materials[0] = LoadMaterialDefault();
+  o.model.materials[0].shader = shader;
+  o.model.meshMaterial = (int*)MemAlloc(WAVE_LEVELS*sizeof(int));
+
+  loadWaveRings(&o);
+  // the web build has no threads, so the whole bake would block the frame it starts on
+  #ifdef __EMSCRIPTEN__
+  if (loop) TraceLog(LOG_WARNING, "WAVES: no wave loop on the web, using noise directly");
+  loop = false;
+  #endif
+  o.loopWanted = loop && !spectrum;
+  o.pool = pool;
+  return o;
+}
+
+void unloadOcean(ocean* o) {
+  unloadWaveRings(o);
+  if (o->spectrum != NULL) unloadWaveSpectrum(o->spectrum);
+  if (o->loop != NULL) unloadWaveLoop(o->loop);
+  if (o->fields != NULL) unloadWaveFields(o->fields);
+  UnloadShader(o->model.materials[0].shader);
+  UnloadModel(o->model);
+}
+
+void setOceanQuality(ocean* o, int quality) {
+  if (quality == o->quality) return;
+  unloadWaveRings(o);
+  // the loop was baked from the old quality's octaves, so it's baked again
+  if (o->loop != NULL) {
+    unloadWaveLoop(o->loop);
+    o->loop = NULL;
+    if (o->fields != NULL) unloadWaveFields(o->fields);
+    o->fields = NULL;
+  }
+  o->quality = quality;
+  loadWaveRings(o);
+  o->stats = (oceanStats){ 0 };
+  o->settle = WAVE_TUNE_SETTLE;
+}
+
+// index of the named quality, or -1 when the name is "auto" or unknown
+int findWaveQuality(const char* name) {
+  for (int i = 0; i < WAVE_QUALITIES; i++) {
+    if (strcmp(name, waveQualities[i].name) == 0) return i;
+  }
+  if (strcmp(name, "auto") != 0) TraceLog(LOG_WARNING, "WAVES: unknown quality %s, measuring instead", name);
+  return -1;
+}
+
+// the longer of WAVE_FRAME_BUDGET and the display's refresh period, since with vsync no frame is shorter than that
+double waveFrameBudget(void) {
+  int refresh = GetMonitorRefreshRate(GetCurrentMonitor());
+  return refresh > 0 ? fmax(WAVE_FRAME_BUDGET, 1.0/refresh) : WAVE_FRAME_BUDGET;
+}
+
+// called once a frame while tuning, with the last frame's time: after each measuring window, keeps the quality if it
+// fit the budget or steps down; a window only counts frames that drew the ocean, any other frame starts it over
+void tuneOcean(ocean* o, float frameTime) {
+  bool drawn = o->drawn;
+  o->drawn = false;
+  if (!o->tuning) return;
+  if (!drawn) {
+    o->stats = (oceanStats){ 0 };
+    return;
+  }
+  if (o->settle > 0) {
+    o->settle--;
+    return;
+  }
+  oceanStats* stats = &o->stats;
+  stats->frameSeconds += frameTime;
+  stats->frames++;
+  if (stats->frameSeconds < WAVE_TUNE_SECONDS) return;
+
+  double frame = stats->frameSeconds/stats->frames;
+  double update = stats->updateSeconds/stats->frames;
+  double waves = stats->waveSeconds/stats->frames;
+  // the worker has its own core, so wave cost only counts against the budget when it makes keyframes late
+  double budget = waveFrameBudget();
+  bool over = frame > 1.1*budget || update > budget/4 || stats->lateFrames > stats->frames/20;
+  TraceLog(LOG_INFO, "WAVES: %s quality: %.2f ms frame, %.2f ms update, %.2f ms keyframes, %i/%i late",
+    waveQualities[o->quality].name, 1000*frame, 1000*update, 1000*waves, stats->lateFrames, stats->frames);
+  if (over && o->quality > 0) {
+    setOceanQuality(o, o->quality - 1);
+  } else {
+    o->tuning = false;
+    TraceLog(LOG_INFO, "WAVES: settled on %s quality", waveQualities[o->quality].name);
+  }
+}
+
+// wave sample of ring `coarse` at a border vertex of the ring inside it, in that ring's lattice units
+void waveRingBorderSample(waveRing* coarse, int fx, int fz, float* sample) {
+  int ox = coarse->cx - coarse->peaks/2;
+  int oz = coarse->cz - coarse->peaks/2;
+  int x0 = (fx - (fx & 1))/2 - ox, x1 = (fx + (fx & 1))/2 - ox;
+  int z0 = (fz - (fz & 1))/2 - oz, z1 = (fz + (fz & 1))/2 - oz;
+  const float* a = &coarse->surface[WAVE_SAMPLE*(z0*coarse->side + x0)];
+  const float* b = &coarse->surface[WAVE_SAMPLE*(z1*coarse->side + x1)];
+  for (int c = 0; c < WAVE_SAMPLE; c++) sample[c] = (a[c] + b[c])/2;
+}
+
+void updateOcean(ocean* o, Vector3 center, double t) {
+  double start = GetTime();
+
+  // bake the loop from the noise of the settled quality, then move over to it once it's baked
+  if (o->loopWanted && o->loop == NULL && !o->tuning) o->loop = loadWaveLoop(o->noise, o->pool);
+  if (o->loop != NULL && o->fields == NULL && !workerBusy(&o->loop->baker)) {
+    workerWait(o->worker);
+    o->fields = loadWaveFields();
+    for (int l = 0; l < WAVE_LEVELS; l++) o->rings[l].started = false;
+  }
+  bool busy = workerBusy(o->worker);
+
+  // follow the center, snapping each ring to even multiples of its spacing
+  bool moved[WAVE_LEVELS] = { 0 };
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    waveRing* ring = &o->rings[l];
+    int cx = 2*(int)roundf(center.x/(2*ring->spacing));
+    int cz = 2*(int)roundf(center.z/(2*ring->spacing));
+    if (cx == ring->cx && cz == ring->cz) continue;
+    ring->cx = cx;
+    ring->cz = cz;
+    moved[l] = true;
+    if (ring->started) {
+      rebaseWaveKeyframe(o, ring, 0);
+      rebaseWaveKeyframe(o, ring, 1);
+    }
+  }
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    if (moved[l] || (l > 0 && moved[l-1])) indexWaveRing(o, l);
+  }
+
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    waveRing* ring = &o->rings[l];
+
+    // (re)start on the keyframe at or before t, computing the first two in place; also catches up after long stalls
+    if (!ring->started || t >= ring->times[1] + ring->step) {
+      workerWait(o->worker);
+      busy = false;
+      ring->requested = false;
+      ring->ready = false;
+      double restart = GetTime();
+      for (int k = 0; k < 2; k++) {
+        requestWaveKeyframe(o, ring, k == 0 ? floor(t/ring->step)*ring->step : ring->times[1] + ring->step);
+        computeWaveKeyframe(o, ring);
+        rotateWaveKeyframes(ring);
+      }
+      o->stats.waveSeconds += GetTime() - restart;
+      ring->started = true;
+    }
+  }
+
+  if (!busy && o->jobSeconds > 0) {
+    o->stats.waveSeconds += o->jobSeconds;
+    o->jobSeconds = 0;
+  }
+  bool submit = false;
+  bool late = false;
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    waveRing* ring = &o->rings[l];
+
+    if (!busy && ring->requested) {
+      ring->requested = false;
+      ring->ready = true;
+    }
+    if (ring->ready) rebaseWaveKeyframe(o, ring, 2);
+
+    // hold on the last keyframe if the worker is late
+    if (ring->ready && t >= ring->times[1]) {
+      rotateWaveKeyframes(ring);
+      ring->ready = false;
+    } else if (t >= ring->times[1]) {
+      late = true;
+    }
+
+    if (!busy && !ring->requested && !ring->ready) {
+      requestWaveKeyframe(o, ring, ring->times[1] + ring->step);
+      ring->requested = true;
+      submit = true;
+    }
+  }
+  if (submit) workerSubmit(o->worker, oceanJob, o);
+  if (late) o->stats.lateFrames++;
+
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    waveRing* ring = &o->rings[l];
+    float alpha = Clamp((float)((t - ring->times[0])/ring->step), 0, 1);
+    const float* a = ring->heights[0];
+    const float* b = ring->heights[1];
+    for (int i = 0; i < ring->side*ring->side*WAVE_SAMPLE; i++) ring->surface[i] = a[i] + alpha*(b[i] - a[i]);
+  }
+
+  // pin each ring's outer border to the coarser ring's surface so neither update rates nor T-junctions open cracks
+  for (int l = 0; l < WAVE_LEVELS-1; l++) {
+    waveRing* ring = &o->rings[l];
+    int ox = ring->cx - ring->peaks/2;
+    int oz = ring->cz - ring->peaks/2;
+    for (int i = 0; i < ring->side; i++) {
+      int edges[4][2] = { { i, 0 }, { i, ring->peaks }, { 0, i }, { ring->peaks, i } };
+      for (int e = 0; e < 4; e++) {
+        int n = edges[e][1]*ring->side + edges[e][0];
+        waveRingBorderSample(&o->rings[l+1], ox + edges[e][0], oz + edges[e][1], &ring->surface[WAVE_SAMPLE*n]);
+      }
+    }
+  }
+
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    waveRing* ring = &o->rings[l];
+    if (!o->vertexFetch) {
+      displaceWaveRing(o, l);
+    } else if (WAVE_HEIGHT_FORMAT == PIXELFORMAT_UNCOMPRESSED_R16G16B16) {
+      unsigned short* halfs = (unsigned short*)o->upload;
+      for (int i = 0; i < ring->side*ring->side*WAVE_SAMPLE; i++) halfs[i] = floatToHalf(ring->surface[i]);
+      streamTexture(&ring->heightMap, halfs);
+    } else {
+      streamTexture(&ring->heightMap, ring->surface);
+    }
+  }
+  o->stats.updateSeconds += GetTime() - start;
+}
+
+void drawOcean(ocean* o) {
+  o->drawn = true;
+  Material material = o->model.materials[0];
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    waveRing* ring = &o->rings[l];
+    Vector2 origin = { waveRingX(ring, ring->cx, 0), waveRingX(ring, ring->cz, 0) };
+    SetShaderValue(material.shader, o->ringOriginLoc, &origin, SHADER_UNIFORM_VEC2);
+    SetShaderValue(material.shader, o->ringSpacingLoc, &ring->spacing, SHADER_UNIFORM_FLOAT);
+    if (o->vertexFetch) material.maps[MATERIAL_MAP_HEIGHT].texture = ring->heightMap.textures[ring->heightMap.current];
+    DrawMesh(o->model.meshes[l], material, o->model.transform);
+  }
+  material.maps[MATERIAL_MAP_HEIGHT].texture = (Texture2D){ 0 };
+}
+
+// world space height of the drawn water surface, read from the finest ring that covers (x, z)
+float oceanHeight(ocean* o, float x, float z) {
+  for (int l = 0; l < WAVE_LEVELS; l++) {
+    waveRing* ring = &o->rings[l];
+    float fx = x/ring->spacing - (ring->cx - ring->peaks/2);
+    float fz = z/ring->spacing - (ring->cz - ring->peaks/2);
+    if (fx < 0 || fz < 0 || fx >= ring->peaks || fz >= ring->peaks) continue;
+
+    int i = (int)fx, j = (int)fz;
+    fx -= i;
+    fz -= j;
+    const float* v = ring->surface;
+    float h00 = v[WAVE_SAMPLE*(j*ring->side + i)];
+    float h10 = v[WAVE_SAMPLE*(j*ring->side + i+1)];
+    float h01 = v[WAVE_SAMPLE*((j+1)*ring->side + i)];
+    float h11 = v[WAVE_SAMPLE*((j+1)*ring->side + i+1)];
+    // same diagonal split as indexWaveRing
+    float h = fz > fx ? h00 + fx*(h11 - h01) + fz*(h01 - h00) : h00 + fx*(h10 - h00) + fz*(h11 - h10);
+    return h + o->model.transform.m13;
+  }
+  return o->model.transform.m13;
+}
+
+// largest power of 2 no larger than n or limit
+int floorPowerOfTwo(int n, int limit) {
+  int p = 1;
+  while (2*p <= n && 2*p <= limit) p *= 2;
+  return p;
+}
+
+// uploads an image for texturing 3D surfaces: mipmapped and trilinear filtered so far away surfaces don't shimmer or
+// thrash the texture cache; the size is rounded down to powers of 2, which mipmaps need on WebGL 1
+Texture2D loadSurfaceTextureFromImage(Image image, int maxSize) {
+  int width = floorPowerOfTwo(image.width, maxSize);
+  int height = floorPowerOfTwo(image.height, maxSize);
+  if (width != image.width || height != image.height) ImageResize(&image, width, height);
+  Texture2D texture = LoadTextureFromImage(image);
+  UnloadImage(image);
+  GenTextureMipmaps(&texture);
+  SetTextureFilter(texture, TEXTURE_FILTER_TRILINEAR);
+  return texture;
+}
+
+// a surface texture from a file; a GPU compressed copy next to it (same name with .ktx) is used instead when the GPU
+// can take its format, since it's already mipmapped and 4-8x smaller in memory
+Texture2D loadSurfaceTexture(const char* path, int maxSize) {
+  const char* compressed = TextFormat("%s.ktx", TextSubtext(path, 0, (int)(GetFileExtension(path) - path)));
+  if (FileExists(compressed)) {
+    Image image = LoadImage(compressed);
+    Texture2D texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    if (texture.id != 0) {
+      SetTextureFilter(texture, texture.mipmaps > 1 ? TEXTURE_FILTER_TRILINEAR : TEXTURE_FILTER_BILINEAR);
+      return texture;
+    }
+  }
+  return loadSurfaceTextureFromImage(LoadImage(path), maxSize);
+}
+
+// textures generated from noise in place of jpgs that are mostly noise anyway, which saves megabytes of download
+typedef enum { NOISE_WOOD, NOISE_METAL, NOISE_CANVAS, NOISE_WATER } noiseStyle;
+
+typedef struct {
+  const char* path; // the jpg it stands in for
+  noiseStyle style;
+  int seed;
+  Color dark, light;
+} noiseTexture;
+
+const noiseTexture noiseTextures[] = {
+  { "assets/wood.jpg", NOISE_WOOD, 11, { 150, 62, 36, 255 }, { 226, 142, 78, 255 } },
+  { "assets/metal.jpg", NOISE_METAL, 23, { 36, 46, 92, 255 }, { 178, 154, 132, 255 } },
+  { "assets/reel.jpg", NOISE_METAL, 37, { 14, 24, 20, 255 }, { 64, 122, 96, 255 } },
+  { "assets/sail.jpg", NOISE_CANVAS, 41, { 214, 138, 70, 255 }, { 250, 216, 162, 255 } },
+  { "assets/line.jpg", NOISE_CANVAS, 53, { 140, 160, 196, 255 }, { 236, 240, 248, 255 } },
+  { "assets/waves.jpg", NOISE_WATER, 67, { 24, 34, 110, 255 }, { 62, 150, 172, 255 } },
+};
+
+// a noise texture for path at size x size, or the file itself when size is 0 or path isn't one of noiseTextures
+Texture2D loadNoiseTexture(const char* path, int size, int maxSize, const fnl_pool* pool) {
+  const noiseTexture* t = NULL;
+  for (int i = 0; i < (int)(sizeof(noiseTextures)/sizeof(noiseTextures[0])); i++) {
+    if (strcmp(path, noiseTextures[i].path) == 0) t = &noiseTextures[i];
+  }
+  if (size <= 0 || t == NULL) return loadSurfaceTexture(path, maxSize);
+
+  // a broad pattern and a fine one, both over 4 units across the texture
+  fnl_state noise = fnlCreateState();
+  noise.seed = t->seed;
+  noise.noise_type = FNL_NOISE_OPENSIMPLEX2;
+  noise.fractal_type = FNL_FRACTAL_FBM;
+  noise.octaves = 4;
+  noise.frequency = 1;
+  fnl_state warp = fnlCreateState();
+  warp.seed = t->seed + 1;
+  warp.frequency = 1;
+  warp.domain_warp_amp = 0.6f;
+  float step = 4.0f/size;
+  float* base = (float*)MemAlloc(size*size*sizeof(float));
+  float* detail = (float*)MemAlloc(size*size*sizeof(float));
+  fnl_image broad = { base, size, size, 1, 0, 0, 0, step, step, 0 };
+  fnl_image fine = { detail, size, size, 1, 0, 0, 0, 16*step, 16*step, 0 };
+  switch (t->style) {
+    case NOISE_WOOD: // grain running along v
+      broad.step_x *= 3;
+      fine.step_y /= 8;
+      break;
+    case NOISE_METAL: // brushed along u
+      fine.step_x /= 16;
+      break;
+    case NOISE_WATER:
+      noise.fractal_type = FNL_FRACTAL_RIDGED;
+      break;
+    default:
+      break;
+  }
+  fnlGenNoiseImage2D(&noise, t->style == NOISE_METAL ? NULL : &warp, &broad, pool);
+  noise.seed += 2;
+  noise.fractal_type = FNL_FRACTAL_FBM;
+  fnlGenNoiseImage2D(&noise, NULL, &fine, pool);
+
+  const float threads = 96; // weave of the canvas, across the texture
+  unsigned char* pixels = (unsigned char*)MemAlloc(size*size*3);
+  for (int j = 0, n = 0; j < size; j++) {
+    for (int i = 0; i < size; i++, n++) {
+      float b = base[n], d = 0.5f + 0.5f*detail[n];
+      float v = 0;
+      switch (t->style) {
+        case NOISE_WOOD:
+          v = 0.65f*(0.5f + 0.5f*sinf(14*b)) + 0.35f*d;
+          break;
+        case NOISE_METAL:
+          v = 0.5f + 0.4f*b + 0.3f*(d - 0.5f);
+          break;
+        case NOISE_CANVAS: {
+          // threads alternate over and under, darker where they dip
+          float u = i*threads/size, w = j*threads/size;
+          bool weft = (((int)u + (int)w) & 1) != 0;
+          float thread = sinf(PI*(weft ? w - floorf(w) : u - floorf(u)));
+          v = 0.6f + 0.35f*b + 0.15f*(thread - 0.7f) + 0.1f*(d - 0.5f);
+        } break;
+        case NOISE_WATER: // bright ridges like caustics
+          v = 0.8f*(0.5f + 0.5f*b)*(0.5f + 0.5f*b) + 0.2f*d;
+          break;
+      }
+      v = Clamp(v, 0, 1);
+      pixels[3*n] = (unsigned char)(t->dark.r + v*(t->light.r - t->dark.r));
+      pixels[3*n+1] = (unsigned char)(t->dark.g + v*(t->light.g - t->dark.g));
+      pixels[3*n+2] = (unsigned char)(t->dark.b + v*(t->light.b - t->dark.b));
+    }
+  }
+  MemFree(base);
+  MemFree(detail);
+
+  Image image = { pixels, size, size, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8 };
+  return loadSurfaceTextureFromImage(image, maxSize);
+}
+
+// the sky used to be a sphere around the camera sunk by SKY_DROP, textured the way GenMeshSphere lays out uvs: u from
+// the +z pole to the -z one, v around z from +x; the cubemap keeps that look from the camera with 12 triangles
+#define SKY_RADIUS ((float)WAVE_SPAN/2)
+#define SKY_DROP 200.0f
+
+typedef struct {
+  Image sky; // R8G8B8
+  unsigned char* faces; // +x, -x, +y, -y, +z, -z, one above the other
+  int size;
+} skyCubemapJob;
+
+// fills one row of a cube face from the sky image
+void skyCubemapRow(void* arg, int row) {
+  skyCubemapJob* job = (skyCubemapJob*)arg;
+  const unsigned char* src = (const unsigned char*)job->sky.data;
+  int face = row/job->size;
+  float t = 2*(row%job->size + 0.5f)/job->size - 1;
+  for (int i = 0; i < job->size; i++) {
+    float s = 2*(i + 0.5f)/job->size - 1;
+    Vector3 d;
+    switch (face) {
+      case 0: d = (Vector3){ 1, -t, -s }; break;
+      case 1: d = (Vector3){ -1, -t, s }; break;
+      case 2: d = (Vector3){ s, 1, t }; break;
+      case 3: d = (Vector3){ s, -1, -t }; break;
+      case 4: d = (Vector3){ s, -t, 1 }; break;
+      default: d = (Vector3){ -s, -t, -1 }; break;
+    }
+    d = Vector3Normalize(d);
+    // where the view ray met the sphere, seen from its centre
+    float b = SKY_DROP*d.y;
+    float along = -b + sqrtf(b*b - SKY_DROP*SKY_DROP + SKY_RADIUS*SKY_RADIUS);
+    Vector3 p = Vector3Normalize((Vector3){ along*d.x, SKY_DROP + along*d.y, along*d.z });
+    float u = acosf(Clamp(p.z, -1, 1))/PI;
+    float v = atan2f(p.y, p.x)/(2*PI);
+    if (v < 0) v += 1;
+
+    // bilinear, wrapping around the sphere in v
+    float x = u*(job->sky.width - 1);
+    float y = v*job->sky.height - 0.5f;
+    if (y < 0) y += job->sky.height;
+    int x0 = (int)x, y0 = (int)y;
+    int x1 = x0 + 1 < job->sky.width ? x0 + 1 : x0;
+    int y1 = (y0 + 1)%job->sky.height;
+    float fx = x - x0, fy = y - y0;
+    unsigned char* out = job->faces + 3*(row*job->size + i);
+    for (int c = 0; c < 3; c++) {
+      float top = src[3*(y0*job->sky.width + x0) + c]*(1 - fx) + src[3*(y0*job->sky.width + x1) + c]*fx;
+      float bottom = src[3*(y1*job->sky.width + x0) + c]*(1 - fx) + src[3*(y1*job->sky.width + x1) + c]*fx;
+      out[c] = (unsigned char)(top + fy*(bottom - top) + 0.5f);
+    }
+  }
+}
+
+// converts the sky image to a cubemap once at load, faces as big as the image has detail for but at most maxSize
+TextureCubemap loadSkyCubemap(const char* path, int maxSize, const fnl_pool* pool) {
+  skyCubemapJob job = { LoadImage(path) };
+  ImageFormat(&job.sky, PIXELFORMAT_UNCOMPRESSED_R8G8B8);
+  // the image's height spans half a turn of the sphere, a face a quarter
+  job.size = floorPowerOfTwo(job.sky.height/2, maxSize);
+  job.faces = (unsigned char*)MemAlloc(6*job.size*job.size*3);
+  if (pool != NULL) pool->parallel_for(pool->pool, skyCubemapRow, &job, 6*job.size);
+  else for (int row = 0; row < 6*job.size; row++) skyCubemapRow(&job, row);
+  UnloadImage(job.sky);
+
+  Image faces = { job.faces, job.size, 6*job.size, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8 };
+  TextureCubemap cubemap = LoadTextureCubemap(faces, CUBEMAP_LAYOUT_LINE_VERTICAL);
+  UnloadImage(faces);
+  SetTextureFilter(cubemap, TEXTURE_FILTER_BILINEAR);
+  return cubemap;
+}
+
+// a unit cube drawn from the inside, at the far plane, with only the camera's rotation
+Model loadSkybox(TextureCubemap cubemap) {
+  Model skybox = LoadModelFromMesh(GenMeshCube(1, 1, 1));
+  Shader shader = LoadShader(TextFormat("assets/shaders/glsl%i/skybox.vs", GLSL_VERSION), TextFormat("assets/shaders/glsl%i/skybox.fs", GLSL_VERSION));
+  shader.locs[SHADER_LOC_MAP_CUBEMAP] = GetShaderLocation(shader, "environmentMap");
+  skybox.materials[0].shader = shader;
+  skybox.materials[0].maps[MATERIAL_MAP_CUBEMAP].texture = cubemap;
+  return skybox;
+}
+
+void unloadSkybox(Model skybox) {
+  UnloadTexture(skybox.materials[0].maps[MATERIAL_MAP_CUBEMAP].texture);
+  UnloadShader(skybox.materials[0].shader);
+  UnloadModel(skybox);
+}
+
+RayCollision GetRayCollisionModel(Ray ray, Model model) {
+  RayCollision collision = { 0 };
+
+  for (int i = 0; i < model.meshCount; i++) {
+    RayCollision newCollision = GetRayCollisionMesh(ray, model.meshes[i], model.transform);
+    if (newCollision.hit && (!collision.hit || collision.distance > newCollision.distance)) {
+      collision = newCollision;
+    }
+  }
+
+  return collision;
+}
+
+Ray RayTransform(Ray r, Matrix mat) {
+  Vector3 position = Vector3Transform(r.position, mat);
+  r.direction = Vector3Normalize(Vector3Subtract(Vector3Transform(Vector3Add(r.position, r.direction), mat), position));
+  r.position = position;
+  return r;
+}
+
+// pixels of an image under a rectangle, kept to put back later
+typedef struct {
+  Image pixels;
+  int x, y;
+} paintPatch;
+
+// the whole pixels rect touches, clipped to the image
+paintPatch savePaintPatch(Image image, Rectangle rect) {
+  paintPatch patch = { 0 };
+  int x0 = (int)floorf(rect.x), y0 = (int)floorf(rect.y);
+  int x1 = (int)ceilf(rect.x + rect.width), y1 = (int)ceilf(rect.y + rect.height);
+  x0 = x0 < 0 ? 0 : x0;
+  y0 = y0 < 0 ? 0 : y0;
+  x1 = x1 > image.width ? image.width : x1;
+  y1 = y1 > image.height ? image.height : y1;
+  if (x1 <= x0 || y1 <= y0) return patch;
+  patch.pixels = ImageFromImage(image, (Rectangle){ (float)x0, (float)y0, (float)(x1 - x0), (float)(y1 - y0) });
+  patch.x = x0;
+  patch.y = y0;
+  return patch;
+}
+
+void unloadPaintPatch(paintPatch* patch) {
+  if (IsImageValid(patch->pixels)) UnloadImage(patch->pixels);
+  *patch = (paintPatch){ 0 };
+}
+
+// copies the pixels back as they were, without blending
+void restorePaintPatch(Image* image, paintPatch* patch) {
+  if (!IsImageValid(patch->pixels)) return;
+  int pixelSize = GetPixelDataSize(1, 1, image->format);
+  for (int j = 0; j < patch->pixels.height; j++) {
+    memcpy((unsigned char*)image->data + ((patch->y + j)*image->width + patch->x)*pixelSize,
+      (const unsigned char*)patch->pixels.data + j*patch->pixels.width*pixelSize, patch->pixels.width*pixelSize);
+  }
+  unloadPaintPatch(patch);
+}
+
+#define STICKER_CACHE_BYTES (48 << 20) // decoded stickers kept around, least recently used dropped first past this
+#define STICKER_CACHE_SLOTS 16
+
+typedef struct {
+  const char* file;
+  Image image; // already turned the way it's drawn onto the canvas
+  unsigned int used; // the cache's clock when last asked for
+} cachedSticker;
+
+// decoded stickers, with the one highlighted in the menu decoded ahead on a worker
+typedef struct {
+  cachedSticker entries[STICKER_CACHE_SLOTS];
+  int count;
+  int bytes;
+  unsigned int clock;
+  worker decoder;
+  const char* decoding; // file the decoder was given, NULL when it has none
+  Image decoded;
+} stickerCache;
+
+void decodeSticker(void* arg) {
+  stickerCache* cache = (stickerCache*)arg;
+  cache->decoded = LoadImage(cache->decoding);
+  ImageRotateCCW(&cache->decoded);
+}
+
+// in place, since the decoder's thread keeps a pointer to it
+void startStickerCache(stickerCache* cache) {
+  *cache = (stickerCache){ 0 };
+  workerStart(&cache->decoder);
+}
+
+void stopStickerCache(stickerCache* cache) {
+  workerWait(&cache->decoder);
+  workerStop(&cache->decoder);
+  if (cache->decoding != NULL) UnloadImage(cache->decoded);
+  for (int i = 0; i < cache->count; i++) UnloadImage(cache->entries[i].image);
+  *cache = (stickerCache){ 0 };
+}
+
+int findCachedSticker(const stickerCache* cache, const char* file) {
+  for (int i = 0; i < cache->count; i++) {
+    if (strcmp(cache->entries[i].file, file) == 0) return i;
+  }
+  return -1;
+}
+
+void evictCachedSticker(stickerCache* cache, int i) {
+  const Image* image = &cache->entries[i].image;
+  cache->bytes -= GetPixelDataSize(image->width, image->height, image->format);
+  UnloadImage(*image);
+  cache->entries[i] = cache->entries[--cache->count];
+}
+
+// the cache keeps owning the image, which is never evicted while it's the newest
+Image insertCachedSticker(stickerCache* cache, const char* file, Image image) {
+  int size = GetPixelDataSize(image.width, image.height, image.format);
+  while (cache->count > 0 && (cache->count == STICKER_CACHE_SLOTS || cache->bytes + size > STICKER_CACHE_BYTES)) {
+    int oldest = 0;
+    for (int i = 1; i < cache->count; i++) {
+      if (cache->entries[i].used < cache->entries[oldest].used) oldest = i;
+    }
+    evictCachedSticker(cache, oldest);
+  }
+  cache->entries[cache->count] = (cachedSticker){ file, image, ++cache->clock };
+  cache->bytes += size;
+  return cache->entries[cache->count++].image;
+}
+
+// takes what the decoder finished, if it has
+void collectDecodedSticker(stickerCache* cache) {
+  if (cache->decoding == NULL || workerBusy(&cache->decoder)) return;
+  workerWait(&cache->decoder);
+  if (IsImageValid(cache->decoded)) insertCachedSticker(cache, cache->decoding, cache->decoded);
+  cache->decoding = NULL;
+  cache->decoded = (Image){ 0 };
+}
+
+// starts decoding a sticker likely to be wanted soon; call it again later if the decoder was busy
+void prefetchSticker(stickerCache* cache, const char* file) {
+  collectDecodedSticker(cache);
+  if (cache->decoding != NULL || findCachedSticker(cache, file) >= 0) return;
+  cache->decoding = file;
+  workerSubmit(&cache->decoder, decodeSticker, cache);
+}
+
+// decodes it here if it wasn't prefetched; the cache keeps owning the image
+Image getSticker(stickerCache* cache, const char* file) {
+  // whatever the decoder is on finishes first: it may be this one, and LoadImage isn't safe on two threads at once
+  workerWait(&cache->decoder);
+  collectDecodedSticker(cache);
+  int i = findCachedSticker(cache, file);
+  if (i >= 0) {
+    cache->entries[i].used = ++cache->clock;
+    return cache->entries[i].image;
+  }
+  Image image = LoadImage(file);
+  ImageRotateCCW(&image);
+  return insertCachedSticker(cache, file, image);
+}
+
+void updateCamera(Camera* camera) {
+  // mouse
+  float rotateSensitivity = 0.003f;
+  Vector2 mousePositionDelta = GetMouseDelta();
+  CameraYaw(camera, -mousePositionDelta.x*rotateSensitivity, false);
+  CameraPitch(camera, -mousePositionDelta.y*rotateSensitivity, true, false, false);
+}
+
+// random looking uvs, hashed from each vertex's position so the copies a model keeps of a vertex in each of its meshes
+// agree, and still weld when static batching merges them
+void randomizeUV(Model model) {
+  for (int i = 0; i < model.meshCount; i++) {
+    float* texcoords = (float*)MemAlloc(model.meshes[i].vertexCount*2*sizeof(float));
+    for (int j = 0; j < model.meshes[i].vertexCount; j++) {
+      // FNV-1a over the position's bytes
+      const unsigned char* bytes = (const unsigned char*)&model.meshes[i].vertices[3*j];
+      unsigned int hash = 2166136261u;
+      for (int b = 0; b < 3*(int)sizeof(float); b++) hash = (hash ^ bytes[b])*16777619u;
+      texcoords[2*j] = (float)(hash & 255)/255;
+      texcoords[2*j+1] = (float)((hash >> 8) & 255)/255;
+    }
+    UpdateMeshBuffer(model.meshes[i], SHADER_LOC_VERTEX_TEXCOORD01, texcoords, model.meshes[i].vertexCount*2*sizeof(float), 0);
+    // the CPU copy is kept in step too, static batching merges from it
+    if (model.meshes[i].texcoords != NULL) MemFree(model.meshes[i].texcoords);
+    model.meshes[i].texcoords = texcoords;
+  }
+}
+
+// load-time mesh optimization: the older models were converted from formats that left them as lots of small meshes
+// (the canvas is a mesh per triangle) with their own copies of shared vertices, so meshes are welded, indexed, and
+// reordered for the post-transform vertex cache, for overdraw and for vertex fetch
+#define MESH_CACHE_SIZE 16 // FIFO entries assumed when ordering and measuring
+#define MESH_OVERDRAW_THRESHOLD 1.05f // how much worse than the whole mesh's ACMR a cluster may be so clusters can move
+
+// cache misses of a run of triangles on a FIFO cache; stamps and time carry the cache between calls, and adding
+// MESH_CACHE_SIZE + 1 to time empties it
+int meshCacheMisses(const unsigned int* indices, int indexCount, int* stamps, int* time) {
+  int misses = 0;
+  for (int i = 0; i < indexCount; i++) {
+    if (*time - stamps[indices[i]] > MESH_CACHE_SIZE) {
+      stamps[indices[i]] = (*time)++;
+      misses++;
+    }
+  }
+  return misses;
+}
+
+// average cache misses per triangle, the usual measure of vertex shader work: 3 without reuse, 0.5 at best
+float meshACMR(const unsigned int* indices, int indexCount, int vertexCount) {
+  int* stamps = (int*)MemAlloc(vertexCount*sizeof(int));
+  int time = MESH_CACHE_SIZE + 1;
+  float acmr = (float)meshCacheMisses(indices, indexCount, stamps, &time)/(indexCount/3);
+  MemFree(stamps);
+  return acmr;
+}
+
+// Tipsify (Sander, Nehab & Barczak 2007): emits the fan around a vertex, then moves to whichever vertex just used is
+// still in the cache with triangles left, falling back to recent vertices and then the rest in order
+void tipsifyMesh(unsigned int* indices, int indexCount, int vertexCount) {
+  int triangleCount = indexCount/3;
+  // triangles around each vertex
+  int* offsets = (int*)MemAlloc((vertexCount + 1)*sizeof(int));
+  for (int i = 0; i < indexCount; i++) offsets[indices[i] + 1]++;
+  for (int v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+  int* live = (int*)MemAlloc(vertexCount*sizeof(int));
+  int* adjacency = (int*)MemAlloc(indexCount*sizeof(int));
+  for (int i = 0; i < indexCount; i++) adjacency[offsets[indices[i]] + live[indices[i]]++] = i/3;
+
+  int* stamps = (int*)MemAlloc(vertexCount*sizeof(int));
+  int* deadEnd = (int*)MemAlloc(indexCount*sizeof(int));
+  int* candidates = (int*)MemAlloc(indexCount*sizeof(int));
+  bool* emitted = (bool*)MemAlloc(triangleCount*sizeof(bool));
+  unsigned int* out = (unsigned int*)MemAlloc(indexCount*sizeof(unsigned int));
+  int outCount = 0, deadEndCount = 0, cursor = 0, time = MESH_CACHE_SIZE + 1;
+  for (int fan = 0; fan >= 0;) {
+    int candidateCount = 0;
+    for (int a = offsets[fan]; a < offsets[fan + 1]; a++) {
+      int t = adjacency[a];
+      if (emitted[t]) continue;
+      for (int k = 0; k < 3; k++) {
+        unsigned int v = indices[3*t + k];
+        out[outCount++] = v;
+        deadEnd[deadEndCount++] = v;
+        candidates[candidateCount++] = v;
+        live[v]--;
+        if (time - stamps[v] > MESH_CACHE_SIZE) stamps[v] = time++;
+      }
+      emitted[t] = true;
+    }
+
+    // the candidate that stays in the cache the longest while its fan is emitted
+    fan = -1;
+    int best = 0;
+    for (int c = 0; c < candidateCount; c++) {
+      int v = candidates[c];
+      if (live[v] <= 0) continue;
+      int age = time - stamps[v];
+      int priority = age + 2*live[v] <= MESH_CACHE_SIZE ? age : 0;
+      if (priority > best) {
+        best = priority;
+        fan = v;
+      }
+    }
+    while (fan < 0 && deadEndCount > 0) {
+      int v = deadEnd[--deadEndCount];
+      if (live[v] > 0) fan = v;
+    }
+    for (; fan < 0 && cursor < vertexCount; cursor++) {
+      if (live[cursor] > 0) fan = cursor;
+    }
+  }
+  memcpy(indices, out, indexCount*sizeof(unsigned int));
+
+  MemFree(offsets);
+  MemFree(live);
+  MemFree(adjacency);
+  MemFree(stamps);
+  MemFree(deadEnd);
+  MemFree(candidates);
+  MemFree(emitted);
+  MemFree(out);
+}
+
+typedef struct {
+  float order;
+  int first; // triangle
+  int count;
+} meshCluster;
+
+int meshClusterCompare(const void* a, const void* b) {
+  float x = ((const meshCluster*)a)->order, y = ((const meshCluster*)b)->order;
+  return (x < y) - (x > y);
+}
+
+// overdraw ordering from the same paper: cut the cache-ordered triangles into clusters that still use the cache well
+// on their own, then draw the clusters that face out from the middle of the mesh first, since they tend to hide the
+// rest; positions of vertex v are at vertices + 3*source[v]
+void sortMeshClusters(unsigned int* indices, int indexCount, int vertexCount, const float* vertices, const int* source) {
+  int triangleCount = indexCount/3;
+  float limit = MESH_OVERDRAW_THRESHOLD*meshACMR(indices, indexCount, vertexCount);
+  meshCluster* clusters = (meshCluster*)MemAlloc(triangleCount*sizeof(meshCluster));
+  int clusterCount = 0;
+  int* stamps = (int*)MemAlloc(vertexCount*sizeof(int));
+  int time = MESH_CACHE_SIZE + 1;
+  for (int t = 0; t < triangleCount;) {
+    meshCluster* cluster = &clusters[clusterCount++];
+    cluster->first = t;
+    time += MESH_CACHE_SIZE + 1;
+    int misses = 0;
+    do {
+      misses += meshCacheMisses(&indices[3*t++], 3, stamps, &time);
+    } while (t < triangleCount && misses > limit*(t - cluster->first));
+    cluster->count = t - cluster->first;
+  }
+  MemFree(stamps);
+
+  Vector3* centres = (Vector3*)MemAlloc(clusterCount*sizeof(Vector3));
+  Vector3* normals = (Vector3*)MemAlloc(clusterCount*sizeof(Vector3));
+  Vector3 centre = { 0 };
+  float area = 0;
+  for (int c = 0; c < clusterCount; c++) {
+    float clusterArea = 0;
+    for (int t = clusters[c].first; t < clusters[c].first + clusters[c].count; t++) {
+      Vector3 p[3];
+      for (int k = 0; k < 3; k++) {
+        const float* v = &vertices[3*source[indices[3*t + k]]];
+        p[k] = (Vector3){ v[0], v[1], v[2] };
+      }
+      // twice the area, pointing along the normal
+      Vector3 normal = Vector3CrossProduct(Vector3Subtract(p[1], p[0]), Vector3Subtract(p[2], p[0]));
+      float a = Vector3Length(normal);
+      Vector3 middle = Vector3Scale(Vector3Add(Vector3Add(p[0], p[1]), p[2]), a/3);
+      centres[c] = Vector3Add(centres[c], middle);
+      normals[c] = Vector3Add(normals[c], normal);
+      centre = Vector3Add(centre, middle);
+      clusterArea += a;
+    }
+    if (clusterArea > 0) centres[c] = Vector3Scale(centres[c], 1/clusterArea);
+    area += clusterArea;
+  }
+  if (area > 0) centre = Vector3Scale(centre, 1/area);
+  for (int c = 0; c < clusterCount; c++) {
+    clusters[c].order = Vector3DotProduct(Vector3Subtract(centres[c], centre), Vector3Normalize(normals[c]));
+  }
+  MemFree(centres);
+  MemFree(normals);
+
+  qsort(clusters, clusterCount, sizeof(meshCluster), meshClusterCompare);
+  unsigned int* out = (unsigned int*)MemAlloc(indexCount*sizeof(unsigned int));
+  for (int c = 0, n = 0; c < clusterCount; c++) {
+    memcpy(&out[n], &indices[3*clusters[c].first], 3*clusters[c].count*sizeof(unsigned int));
+    n += 3*clusters[c].count;
+  }
+  memcpy(indices, out, indexCount*sizeof(unsigned int));
+  MemFree(out);
+  MemFree(clusters);
+}
 
-#define WAVE_PEAKS 128
-#define WAVE_SPAN 1024
-#define WAVE_TEX_TILES 8
+#define MESH_ATTRIBUTES 6
 
-#define UNLOCK_ALL 0
-#define SHOW_FPS 0
+// the per-vertex arrays of a mesh, NULL or not, with their bytes per vertex, for welding and copying vertices whole
+void meshAttributes(Mesh* mesh, void** arrays[MESH_ATTRIBUTES], int sizes[MESH_ATTRIBUTES]) {
+  void** fields[MESH_ATTRIBUTES] = {
+    (void**)&mesh->vertices, (void**)&mesh->texcoords, (void**)&mesh->texcoords2,
+    (void**)&mesh->normals, (void**)&mesh->tangents, (void**)&mesh->colors
+  };
+  const int fieldSizes[MESH_ATTRIBUTES] = { 3*sizeof(float), 2*sizeof(float), 2*sizeof(float), 3*sizeof(float), 4*sizeof(float), 4 };
+  for (int i = 0; i < MESH_ATTRIBUTES; i++) {
+    arrays[i] = fields[i];
+    sizes[i] = fieldSizes[i];
+  }
+}
 
-typedef enum { MODE_INTRO, MODE_FISHING, MODE_AWARD, MODE_GOFISH, MODE_JUKEBOX, MODE_CANVAS, MODE_PAINT } mode;
+// drops the CPU copy of a mesh that's uploaded and only drawn from then on; the indices are kept, they're small and
+// DrawMesh goes by whether they're there to draw indexed
+void releaseMeshData(Mesh* mesh) {
+  void** attributes[MESH_ATTRIBUTES];
+  int sizes[MESH_ATTRIBUTES];
+  meshAttributes(mesh, attributes, sizes);
+  for (int a = 0; a < MESH_ATTRIBUTES; a++) {
+    MemFree(*attributes[a]);
+    *attributes[a] = NULL;
+  }
+}
 
-typedef enum { STATE_POLE, STATE_WINDING, STATE_CASTING, STATE_CAST, STATE_HOOKED, STATE_REELING } state;
+void releaseModelData(Model model) {
+  for (int i = 0; i < model.meshCount; i++) releaseMeshData(&model.meshes[i]);
+}
 
-typedef struct { char* file; char* display; } catch;
+// for meshes that were never uploaded
+void unloadMeshArrays(Mesh* mesh) {
+  releaseMeshData(mesh);
+  MemFree(mesh->indices);
+  mesh->indices = NULL;
+}
 
-bool randomEvent(float avgSeconds) {
-  return GetRandomValue(1, (int)128*avgSeconds/GetFrameTime()) <= 128;
+// a welded and reordered copy of a mesh's CPU arrays into out, logging the ACMR before and after; false for meshes
+// that are animated or would need 32 bit indices, which are better left as they are
+bool optimizeMesh(Mesh* mesh, Mesh* out, const char* name) {
+  if (mesh->boneIds != NULL || mesh->animVertices != NULL || mesh->vertexCount == 0) return false;
+  int indexCount = mesh->indices != NULL ? 3*mesh->triangleCount : mesh->vertexCount;
+  unsigned int* indices = (unsigned int*)MemAlloc(indexCount*sizeof(unsigned int));
+  for (int i = 0; i < indexCount; i++) indices[i] = mesh->indices != NULL ? mesh->indices[i] : (unsigned int)i;
+  float before = meshACMR(indices, indexCount, mesh->vertexCount);
+
+  // weld vertices that are equal in every attribute, through an open addressed hash table of first occurrences
+  void** attributes[MESH_ATTRIBUTES];
+  int sizes[MESH_ATTRIBUTES];
+  meshAttributes(mesh, attributes, sizes);
+  int tableSize = 1;
+  while (tableSize < 2*mesh->vertexCount) tableSize *= 2;
+  int* table = (int*)MemAlloc(tableSize*sizeof(int)); // vertex + 1, 0 when empty
+  int* weld = (int*)MemAlloc(mesh->vertexCount*sizeof(int));
+  int* source = (int*)MemAlloc(mesh->vertexCount*sizeof(int)); // first occurrence of each welded vertex
+  int vertexCount = 0;
+  for (int v = 0; v < mesh->vertexCount; v++) {
+    unsigned int key = 2166136261u;
+    for (int a = 0; a < MESH_ATTRIBUTES; a++) {
+      if (*attributes[a] == NULL) continue;
+      const unsigned char* bytes = (const unsigned char*)*attributes[a] + v*sizes[a];
+      for (int b = 0; b < sizes[a]; b++) key = (key ^ bytes[b])*16777619u;
+    }
+    int slot = key & (tableSize - 1);
+    for (; table[slot] != 0; slot = (slot + 1) & (tableSize - 1)) {
+      int other = table[slot] - 1;
+      bool equal = true;
+      for (int a = 0; a < MESH_ATTRIBUTES && equal; a++) {
+        const unsigned char* data = (const unsigned char*)*attributes[a];
+        equal = data == NULL || memcmp(data + v*sizes[a], data + other*sizes[a], sizes[a]) == 0;
+      }
+      if (equal) break;
+    }
+    if (table[slot] == 0) {
+      table[slot] = v + 1;
+      source[vertexCount] = v;
+      weld[v] = vertexCount++;
+    } else {
+      weld[v] = weld[table[slot] - 1];
+    }
+  }
+  MemFree(table);
+  bool fits = vertexCount <= 65535;
+
+  if (fits) {
+    for (int i = 0; i < indexCount; i++) indices[i] = weld[indices[i]];
+    tipsifyMesh(indices, indexCount, vertexCount);
+    sortMeshClusters(indices, indexCount, vertexCount, mesh->vertices, source);
+    float after = meshACMR(indices, indexCount, vertexCount);
+
+    // vertices in the order they're first used, so fetching them walks memory forwards
+    int* order = (int*)MemAlloc(vertexCount*sizeof(int));
+    for (int v = 0; v < vertexCount; v++) order[v] = -1;
+    int* fetch = (int*)MemAlloc(vertexCount*sizeof(int)); // original vertex of each new one
+    *out = (Mesh){ 0 };
+    out->triangleCount = indexCount/3;
+    out->indices = (unsigned short*)MemAlloc(indexCount*sizeof(unsigned short));
+    for (int i = 0; i < indexCount; i++) {
+      if (order[indices[i]] < 0) {
+        fetch[out->vertexCount] = source[indices[i]];
+        order[indices[i]] = out->vertexCount++;
+      }
+      out->indices[i] = (unsigned short)order[indices[i]];
+    }
+    void** copies[MESH_ATTRIBUTES];
+    meshAttributes(out, copies, sizes);
+    for (int a = 0; a < MESH_ATTRIBUTES; a++) {
+      if (*attributes[a] == NULL) continue;
+      unsigned char* copy = (unsigned char*)MemAlloc(out->vertexCount*sizes[a]);
+      for (int v = 0; v < out->vertexCount; v++) {
+        memcpy(copy + v*sizes[a], (const unsigned char*)*attributes[a] + fetch[v]*sizes[a], sizes[a]);
+      }
+      *copies[a] = copy;
+    }
+    MemFree(order);
+    MemFree(fetch);
+    TraceLog(LOG_INFO, "MESH: [%s] %i -> %i vertices, ACMR %.2f -> %.2f", name, mesh->vertexCount, out->vertexCount, before, after);
+  }
+  MemFree(indices);
+  MemFree(weld);
+  MemFree(source);
+  return fits;
+}
+
+// LoadModel with every mesh optimized
+Model loadOptimizedModel(const char* path) {
+  Model model = LoadModel(path);
+  for (int m = 0; m < model.meshCount; m++) {
+    Mesh optimized;
+    if (!optimizeMesh(&model.meshes[m], &optimized, TextFormat("%s mesh %i", path, m))) continue;
+    UploadMesh(&optimized, false);
+    UnloadMesh(model.meshes[m]);
+    model.meshes[m] = optimized;
+  }
+  return model;
+}
+
+// levels of detail by quadric error simplification (Garland & Heckbert 1997): vertices collapse along edges onto
+// their neighbours, cheapest first, where the cost is the summed squared distance to the planes of the triangles each
+// side had around it. Positions are collapsed as a whole, so seams in normals and uvs move together, and vertices on
+// open borders stay put so outlines don't shrink
+#define LOD_LEVELS 3 // full detail, then each level aiming for half the triangles of the one before
+#define LOD_MAX_ERROR 1.0f // furthest a simplified surface may stray, in world units
+#define LOD_PIXEL_ERROR 1.0f // a level is drawn once its error covers less than this many pixels
+
+// symmetric 4x4 matrix of plane equations: aa ab ac ad bb bc bd cc cd dd
+typedef struct {
+  double q[10];
+} quadric;
+
+void quadricAddPlane(quadric* q, double a, double b, double c, double d) {
+  double plane[10] = { a*a, a*b, a*c, a*d, b*b, b*c, b*d, c*c, c*d, d*d };
+  for (int i = 0; i < 10; i++) q->q[i] += plane[i];
+}
+
+double quadricError(const quadric* q, Vector3 p) {
+  const double* m = q->q;
+  double x = p.x, y = p.y, z = p.z;
+  return m[0]*x*x + 2*m[1]*x*y + 2*m[2]*x*z + 2*m[3]*x + m[4]*y*y + 2*m[5]*y*z + 2*m[6]*y + m[7]*z*z + 2*m[8]*z + m[9];
 }
 
-float waveHeight(fnl_state* noise, float x, float z, float t) {
-  return 5*fnlGetNoise3D(noise, 2*x, 2*z, 30*t);
+typedef struct {
+  double cost;
+  int from, to;
+} lodCollapse;
+
+int lodCollapseCompare(const void* a, const void* b) {
+  double x = ((const lodCollapse*)a)->cost, y = ((const lodCollapse*)b)->cost;
+  return (x > y) - (x < y);
+}
+
+int lodFind(int* remap, int g) {
+  while (remap[g] != g) g = remap[g] = remap[remap[g]];
+  return g;
+}
+
+Vector3 lodPosition(const Mesh* mesh, int v) {
+  return (Vector3){ mesh->vertices[3*v], mesh->vertices[3*v+1], mesh->vertices[3*v+2] };
+}
+
+Vector3 lodNormal(Vector3 a, Vector3 b, Vector3 c) {
+  return Vector3CrossProduct(Vector3Subtract(b, a), Vector3Subtract(c, a));
 }
 
-void genWaveVertices(fnl_state* noise, float* vertices) {
-  FNLfloat t = (FNLfloat)GetTime();
+// writes the triangles of a simplified mesh, over the same vertices, to destination and returns how many there are;
+// stops at targetTriangles or when the next collapse would stray more than maxError, and sets error to how far the
+// result may have strayed
+int simplifyMesh(const Mesh* mesh, unsigned short* destination, int targetTriangles, float maxError, float* error) {
+  int indexCount = 3*mesh->triangleCount;
+  // one group per distinct position, with the vertices in it
+  int* groupOf = (int*)MemAlloc(mesh->vertexCount*sizeof(int));
+  int* groupVertex = (int*)MemAlloc(mesh->vertexCount*sizeof(int)); // first vertex in each group
+  int tableSize = 1;
+  while (tableSize < 2*mesh->vertexCount) tableSize *= 2;
+  int* table = (int*)MemAlloc(tableSize*sizeof(int)); // group + 1, 0 when empty
+  int groupCount = 0;
+  for (int v = 0; v < mesh->vertexCount; v++) {
+    unsigned int key = 2166136261u;
+    const unsigned char* bytes = (const unsigned char*)&mesh->vertices[3*v];
+    for (int b = 0; b < 3*(int)sizeof(float); b++) key = (key ^ bytes[b])*16777619u;
+    int slot = key & (tableSize - 1);
+    while (table[slot] != 0 && memcmp(&mesh->vertices[3*groupVertex[table[slot] - 1]], &mesh->vertices[3*v], 3*sizeof(float)) != 0) {
+      slot = (slot + 1) & (tableSize - 1);
+    }
+    if (table[slot] == 0) {
+      groupVertex[groupCount] = v;
+      table[slot] = ++groupCount;
+    }
+    groupOf[v] = table[slot] - 1;
+  }
+  MemFree(table);
+
+  int* triangles = (int*)MemAlloc(indexCount*sizeof(int)); // groups, with collapsed triangles removed as we go
+  int triangleCount = mesh->triangleCount;
+  for (int i = 0; i < indexCount; i++) triangles[i] = groupOf[mesh->indices[i]];
+  int* remap = (int*)MemAlloc(groupCount*sizeof(int));
+  for (int g = 0; g < groupCount; g++) remap[g] = g;
+  quadric* quadrics = (quadric*)MemAlloc(groupCount*sizeof(quadric));
+  bool* locked = (bool*)MemAlloc(groupCount*sizeof(bool));
+  bool* touched = (bool*)MemAlloc(groupCount*sizeof(bool));
+  int* offsets = (int*)MemAlloc((groupCount + 1)*sizeof(int));
+  int* filled = (int*)MemAlloc((groupCount + 1)*sizeof(int));
+  int* adjacency = (int*)MemAlloc(indexCount*sizeof(int));
+  lodCollapse* collapses = (lodCollapse*)MemAlloc(indexCount*sizeof(lodCollapse));
+
+  for (int t = 0; t < triangleCount; t++) {
+    Vector3 p = lodPosition(mesh, groupVertex[triangles[3*t]]);
+    Vector3 normal = lodNormal(p, lodPosition(mesh, groupVertex[triangles[3*t+1]]), lodPosition(mesh, groupVertex[triangles[3*t+2]]));
+    if (Vector3Length(normal) == 0) continue;
+    normal = Vector3Normalize(normal);
+    for (int k = 0; k < 3; k++) quadricAddPlane(&quadrics[triangles[3*t+k]], normal.x, normal.y, normal.z, -Vector3DotProduct(normal, p));
+  }
+
+  double worst = 0;
+  double limit = (double)maxError*maxError;
+  for (bool first = true; triangleCount > targetTriangles; first = false) {
+    // drop collapsed triangles and find the ones around each group
+    int kept = 0;
+    for (int t = 0; t < triangleCount; t++) {
+      int a = lodFind(remap, triangles[3*t]), b = lodFind(remap, triangles[3*t+1]), c = lodFind(remap, triangles[3*t+2]);
+      if (a == b || b == c || c == a) continue;
+      triangles[3*kept] = a;
+      triangles[3*kept+1] = b;
+      triangles[3*kept+2] = c;
+      kept++;
+    }
+    triangleCount = kept;
+    memset(offsets, 0, (groupCount + 1)*sizeof(int));
+    for (int i = 0; i < 3*triangleCount; i++) offsets[triangles[i] + 1]++;
+    for (int g = 0; g < groupCount; g++) offsets[g + 1] += offsets[g];
+    memset(filled, 0, groupCount*sizeof(int));
+    for (int i = 0; i < 3*triangleCount; i++) adjacency[offsets[triangles[i]] + filled[triangles[i]]++] = i/3;
+    memset(touched, 0, groupCount*sizeof(bool));
+
+    // edges used by one triangle are on a border
+    if (first) {
+      for (int t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++) {
+          int a = triangles[3*t+k], b = triangles[3*t+(k+1)%3];
+          int shared = 0;
+          for (int j = offsets[a]; j < offsets[a+1]; j++) {
+            const int* other = &triangles[3*adjacency[j]];
+            if (other[0] == b || other[1] == b || other[2] == b) shared++;
+          }
+          if (shared == 1) locked[a] = locked[b] = true;
+        }
+      }
+    }
+
+    int collapseCount = 0;
+    for (int t = 0; t < triangleCount; t++) {
+      for (int k = 0; k < 3; k++) {
+        int a = triangles[3*t+k], b = triangles[3*t+(k+1)%3];
+        quadric q = quadrics[a];
+        for (int i = 0; i < 10; i++) q.q[i] += quadrics[b].q[i];
+        double ab = locked[a] ? INFINITY : quadricError(&q, lodPosition(mesh, groupVertex[b]));
+        double ba = locked[b] ? INFINITY : quadricError(&q, lodPosition(mesh, groupVertex[a]));
+        if (ab == INFINITY && ba == INFINITY) continue;
+        collapses[collapseCount++] = ab <= ba ? (lodCollapse){ ab, a, b } : (lodCollapse){ ba, b, a };
+      }
+    }
+    qsort(collapses, collapseCount, sizeof(lodCollapse), lodCollapseCompare);
+
+    int collapsed = 0;
+    for (int c = 0; c < collapseCount && triangleCount > targetTriangles && collapses[c].cost <= limit; c++) {
+      int from = collapses[c].from, to = collapses[c].to;
+      if (touched[from] || touched[to]) continue;
+      // refuse collapses that would turn a triangle over
+      bool flips = false;
+      int removed = 0;
+      Vector3 target = lodPosition(mesh, groupVertex[to]);
+      for (int j = offsets[from]; j < offsets[from+1] && !flips; j++) {
+        const int* tri = &triangles[3*adjacency[j]];
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+          removed++;
+          continue;
+        }
+        Vector3 p[3], moved[3];
+        for (int k = 0; k < 3; k++) {
+          p[k] = lodPosition(mesh, groupVertex[tri[k]]);
+          moved[k] = tri[k] == from ? target : p[k];
+        }
+        flips = Vector3DotProduct(lodNormal(p[0], p[1], p[2]), lodNormal(moved[0], moved[1], moved[2])) <= 0;
+      }
+      if (flips) continue;
+
+      remap[from] = to;
+      for (int i = 0; i < 10; i++) quadrics[to].q[i] += quadrics[from].q[i];
+      for (int j = offsets[from]; j < offsets[from+1]; j++) {
+        for (int k = 0; k < 3; k++) touched[triangles[3*adjacency[j] + k]] = true;
+      }
+      triangleCount -= removed;
+      if (collapses[c].cost > worst) worst = collapses[c].cost;
+      collapsed++;
+    }
+    if (collapsed == 0) break;
+  }
 
-  int i = 0;
-  for (int z = 0; z < WAVE_PEAKS; z++) {
-    float zPos = ((float)z/WAVE_PEAKS - 0.5f)*WAVE_SPAN;
-    for (int x = 0; x < WAVE_PEAKS; x++) {
-      float xPos = ((float)x/WAVE_PEAKS - 0.5f)*WAVE_SPAN;
-      vertices[i++] = xPos;
-      vertices[i++] = waveHeight(noise, xPos, zPos, t);
-      vertices[i++] = zPos;
+  // back to vertices: a corner whose group moved takes the vertex of the new group nearest to it in normal and uv
+  int* members = (int*)MemAlloc(mesh->vertexCount*sizeof(int));
+  memset(offsets, 0, (groupCount + 1)*sizeof(int));
+  memset(filled, 0, groupCount*sizeof(int));
+  for (int v = 0; v < mesh->vertexCount; v++) offsets[groupOf[v] + 1]++;
+  for (int g = 0; g < groupCount; g++) offsets[g + 1] += offsets[g];
+  for (int v = 0; v < mesh->vertexCount; v++) members[offsets[groupOf[v]] + filled[groupOf[v]]++] = v;
+  int written = 0;
+  for (int t = 0; t < mesh->triangleCount; t++) {
+    int groups[3];
+    for (int k = 0; k < 3; k++) groups[k] = lodFind(remap, groupOf[mesh->indices[3*t+k]]);
+    if (groups[0] == groups[1] || groups[1] == groups[2] || groups[2] == groups[0]) continue;
+    for (int k = 0; k < 3; k++) {
+      int v = mesh->indices[3*t+k];
+      int best = v;
+      if (groups[k] != groupOf[v]) {
+        float nearest = INFINITY;
+        for (int m = offsets[groups[k]]; m < offsets[groups[k] + 1]; m++) {
+          int u = members[m];
+          float d = 0;
+          for (int i = 0; i < 3 && mesh->normals != NULL; i++) d += (mesh->normals[3*u+i] - mesh->normals[3*v+i])*(mesh->normals[3*u+i] - mesh->normals[3*v+i]);
+          for (int i = 0; i < 2 && mesh->texcoords != NULL; i++) d += (mesh->texcoords[2*u+i] - mesh->texcoords[2*v+i])*(mesh->texcoords[2*u+i] - mesh->texcoords[2*v+i]);
+          if (d < nearest) {
+            nearest = d;
+            best = u;
+          }
+        }
+      }
+      destination[3*written + k] = (unsigned short)best;
     }
+    written++;
   }
+  *error = (float)sqrt(worst);
+  MemFree(members);
+
+  MemFree(groupOf);
+  MemFree(groupVertex);
+  MemFree(triangles);
+  MemFree(remap);
+  MemFree(quadrics);
+  MemFree(locked);
+  MemFree(touched);
+  MemFree(offsets);
+  MemFree(filled);
+  MemFree(adjacency);
+  MemFree(collapses);
+  return written;
 }
 
-RayCollision GetRayCollisionModel(Ray ray, Model model) {
+// simplified copies of a mesh, each aiming for half the triangles of the one before; stops early once a level barely
+// helps. errors are how far each level may stray from the full mesh
+int loadMeshLods(const Mesh* mesh, Mesh lods[LOD_LEVELS - 1], float errors[LOD_LEVELS - 1], const char* name) {
+  if (mesh->indices == NULL) return 0;
+  int count = 0;
+  for (const Mesh* finer = mesh; count < LOD_LEVELS - 1; finer = &lods[count - 1]) {
+    unsigned short* indices = (unsigned short*)MemAlloc(3*finer->triangleCount*sizeof(unsigned short));
+    float error;
+    Mesh coarse = *finer;
+    coarse.indices = indices;
+    coarse.triangleCount = simplifyMesh(finer, indices, finer->triangleCount/2, LOD_MAX_ERROR, &error);
+    bool kept = coarse.triangleCount > 0 && coarse.triangleCount <= 3*finer->triangleCount/4 &&
+      optimizeMesh(&coarse, &lods[count], TextFormat("%s lod %i", name, count + 1));
+    MemFree(indices);
+    if (!kept) break;
+    errors[count] = error + (count > 0 ? errors[count - 1] : 0);
+    count++;
+  }
+  return count;
+}
+
+// four floats worked on at once: SSE on x86, NEON on 64-bit ARM, SIMD128 on the web, plain arrays anywhere else
+// comparisons give masks that are only meant for lanesAnd, lanesOr and lanesMask
+#if defined(__SSE__) || defined(_M_X64)
+typedef __m128 lanes;
+lanes lanesLoad(const float* p) { return _mm_loadu_ps(p); }
+void lanesStore(float* p, lanes a) { _mm_storeu_ps(p, a); }
+lanes lanesSet(float x) { return _mm_set1_ps(x); }
+lanes lanesAdd(lanes a, lanes b) { return _mm_add_ps(a, b); }
+lanes lanesSub(lanes a, lanes b) { return _mm_sub_ps(a, b); }
+lanes lanesMul(lanes a, lanes b) { return _mm_mul_ps(a, b); }
+lanes lanesDiv(lanes a, lanes b) { return _mm_div_ps(a, b); }
+lanes lanesMin(lanes a, lanes b) { return _mm_min_ps(a, b); }
+lanes lanesMax(lanes a, lanes b) { return _mm_max_ps(a, b); }
+lanes lanesLess(lanes a, lanes b) { return _mm_cmplt_ps(a, b); }
+lanes lanesLessEqual(lanes a, lanes b) { return _mm_cmple_ps(a, b); }
+lanes lanesAnd(lanes a, lanes b) { return _mm_and_ps(a, b); }
+lanes lanesOr(lanes a, lanes b) { return _mm_or_ps(a, b); }
+int lanesMask(lanes a) { return _mm_movemask_ps(a); }
+#elif defined(__aarch64__) || defined(_M_ARM64)
+typedef float32x4_t lanes;
+lanes lanesLoad(const float* p) { return vld1q_f32(p); }
+void lanesStore(float* p, lanes a) { vst1q_f32(p, a); }
+lanes lanesSet(float x) { return vdupq_n_f32(x); }
+lanes lanesAdd(lanes a, lanes b) { return vaddq_f32(a, b); }
+lanes lanesSub(lanes a, lanes b) { return vsubq_f32(a, b); }
+lanes lanesMul(lanes a, lanes b) { return vmulq_f32(a, b); }
+lanes lanesDiv(lanes a, lanes b) { return vdivq_f32(a, b); }
+lanes lanesMin(lanes a, lanes b) { return vminq_f32(a, b); }
+lanes lanesMax(lanes a, lanes b) { return vmaxq_f32(a, b); }
+lanes lanesLess(lanes a, lanes b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+lanes lanesLessEqual(lanes a, lanes b) { return vreinterpretq_f32_u32(vcleq_f32(a, b)); }
+lanes lanesAnd(lanes a, lanes b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+lanes lanesOr(lanes a, lanes b) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+int lanesMask(lanes a) {
+  uint32x4_t bits = vshrq_n_u32(vreinterpretq_u32_f32(a), 31);
+  return vgetq_lane_u32(bits, 0) | vgetq_lane_u32(bits, 1) << 1 | vgetq_lane_u32(bits, 2) << 2 | vgetq_lane_u32(bits, 3) << 3;
+}
+#elif defined(__wasm_simd128__)
+typedef v128_t lanes;
+lanes lanesLoad(const float* p) { return wasm_v128_load(p); }
+void lanesStore(float* p, lanes a) { wasm_v128_store(p, a); }
+lanes lanesSet(float x) { return wasm_f32x4_splat(x); }
+lanes lanesAdd(lanes a, lanes b) { return wasm_f32x4_add(a, b); }
+lanes lanesSub(lanes a, lanes b) { return wasm_f32x4_sub(a, b); }
+lanes lanesMul(lanes a, lanes b) { return wasm_f32x4_mul(a, b); }
+lanes lanesDiv(lanes a, lanes b) { return wasm_f32x4_div(a, b); }
+lanes lanesMin(lanes a, lanes b) { return wasm_f32x4_pmin(a, b); }
+lanes lanesMax(lanes a, lanes b) { return wasm_f32x4_pmax(a, b); }
+lanes lanesLess(lanes a, lanes b) { return wasm_f32x4_lt(a, b); }
+lanes lanesLessEqual(lanes a, lanes b) { return wasm_f32x4_le(a, b); }
+lanes lanesAnd(lanes a, lanes b) { return wasm_v128_and(a, b); }
+lanes lanesOr(lanes a, lanes b) { return wasm_v128_or(a, b); }
+int lanesMask(lanes a) { return wasm_i32x4_bitmask(a); }
+#else
+typedef struct { float v[4]; } lanes;
+lanes lanesLoad(const float* p) { lanes r; memcpy(r.v, p, sizeof(r.v)); return r; }
+void lanesStore(float* p, lanes a) { memcpy(p, a.v, sizeof(a.v)); }
+lanes lanesSet(float x) { return (lanes){ { x, x, x, x } }; }
+#define LANES_EACH(expression) lanes r; for (int i = 0; i < 4; i++) r.v[i] = (expression); return r
+lanes lanesAdd(lanes a, lanes b) { LANES_EACH(a.v[i] + b.v[i]); }
+lanes lanesSub(lanes a, lanes b) { LANES_EACH(a.v[i] - b.v[i]); }
+lanes lanesMul(lanes a, lanes b) { LANES_EACH(a.v[i]*b.v[i]); }
+lanes lanesDiv(lanes a, lanes b) { LANES_EACH(a.v[i]/b.v[i]); }
+lanes lanesMin(lanes a, lanes b) { LANES_EACH(a.v[i] < b.v[i] ? a.v[i] : b.v[i]); }
+lanes lanesMax(lanes a, lanes b) { LANES_EACH(a.v[i] > b.v[i] ? a.v[i] : b.v[i]); }
+lanes lanesLess(lanes a, lanes b) { LANES_EACH(a.v[i] < b.v[i]); }
+lanes lanesLessEqual(lanes a, lanes b) { LANES_EACH(a.v[i] <= b.v[i]); }
+lanes lanesAnd(lanes a, lanes b) { LANES_EACH(a.v[i] != 0 && b.v[i] != 0); }
+lanes lanesOr(lanes a, lanes b) { LANES_EACH(a.v[i] != 0 || b.v[i] != 0); }
+int lanesMask(lanes a) { int m = 0; for (int i = 0; i < 4; i++) m |= (a.v[i] != 0) << i; return m; }
+#undef LANES_EACH
+#endif
+
+lanes lanesDot(lanes ax, lanes ay, lanes az, lanes bx, lanes by, lanes bz) {
+  return lanesAdd(lanesAdd(lanesMul(ax, bx), lanesMul(ay, by)), lanesMul(az, bz));
+}
+
+// a*d - b*c, one component of a cross product
+lanes lanesCross(lanes a, lanes d, lanes b, lanes c) {
+  return lanesSub(lanesMul(a, d), lanesMul(b, c));
+}
+
+// triangles four at a time with each coordinate in its own array, so a query meets all four at once
+// lanes past the last triangle are NAN, which fails every comparison
+typedef struct {
+  float ax[4], ay[4], az[4]; // first corner
+  float e1x[4], e1y[4], e1z[4]; // to the second corner
+  float e2x[4], e2y[4], e2z[4]; // to the third corner
+} trianglePacket;
+
+trianglePacket* loadTrianglePackets(const Mesh* mesh, int* packetCount) {
+  *packetCount = (mesh->triangleCount + 3)/4;
+  trianglePacket* packets = (trianglePacket*)MemAlloc(*packetCount*sizeof(trianglePacket));
+  for (int i = 0; i < 4*(*packetCount); i++) {
+    trianglePacket* p = &packets[i/4];
+    int k = i%4;
+    if (i >= mesh->triangleCount) {
+      p->ax[k] = p->ay[k] = p->az[k] = NAN;
+      p->e1x[k] = p->e1y[k] = p->e1z[k] = NAN;
+      p->e2x[k] = p->e2y[k] = p->e2z[k] = NAN;
+      continue;
+    }
+    Vector3 corners[3];
+    for (int c = 0; c < 3; c++) corners[c] = lodPosition(mesh, mesh->indices != NULL ? mesh->indices[3*i + c] : 3*i + c);
+    Vector3 e1 = Vector3Subtract(corners[1], corners[0]);
+    Vector3 e2 = Vector3Subtract(corners[2], corners[0]);
+    p->ax[k] = corners[0].x; p->ay[k] = corners[0].y; p->az[k] = corners[0].z;
+    p->e1x[k] = e1.x; p->e1y[k] = e1.y; p->e1z[k] = e1.z;
+    p->e2x[k] = e2.x; p->e2y[k] = e2.y; p->e2z[k] = e2.z;
+  }
+  return packets;
+}
+
+void packetCorners(const trianglePacket* p, int k, Vector3 corners[3]) {
+  corners[0] = (Vector3){ p->ax[k], p->ay[k], p->az[k] };
+  corners[1] = Vector3Add(corners[0], (Vector3){ p->e1x[k], p->e1y[k], p->e1z[k] });
+  corners[2] = Vector3Add(corners[0], (Vector3){ p->e2x[k], p->e2y[k], p->e2z[k] });
+}
+
+// nearest hit among the packets, the same test GetRayCollisionTriangle makes but against four triangles at once
+RayCollision packetRayCollision(Ray ray, const trianglePacket* packets, int packetCount) {
+  lanes ox = lanesSet(ray.position.x), oy = lanesSet(ray.position.y), oz = lanesSet(ray.position.z);
+  lanes dx = lanesSet(ray.direction.x), dy = lanesSet(ray.direction.y), dz = lanesSet(ray.direction.z);
+  lanes zero = lanesSet(0), one = lanesSet(1);
+  lanes epsilon = lanesSet(EPSILON), negativeEpsilon = lanesSet(-EPSILON);
+  float nearest = INFINITY;
+  int nearestTriangle = -1;
+
+  for (int i = 0; i < packetCount; i++) {
+    const trianglePacket* p = &packets[i];
+    lanes e1x = lanesLoad(p->e1x), e1y = lanesLoad(p->e1y), e1z = lanesLoad(p->e1z);
+    lanes e2x = lanesLoad(p->e2x), e2y = lanesLoad(p->e2y), e2z = lanesLoad(p->e2z);
+
+    lanes px = lanesCross(dy, e2z, dz, e2y);
+    lanes py = lanesCross(dz, e2x, dx, e2z);
+    lanes pz = lanesCross(dx, e2y, dy, e2x);
+    lanes det = lanesDot(e1x, e1y, e1z, px, py, pz);
+    lanes inverse = lanesDiv(one, det);
+
+    lanes tx = lanesSub(ox, lanesLoad(p->ax)), ty = lanesSub(oy, lanesLoad(p->ay)), tz = lanesSub(oz, lanesLoad(p->az));
+    lanes u = lanesMul(lanesDot(tx, ty, tz, px, py, pz), inverse);
+    lanes qx = lanesCross(ty, e1z, tz, e1y);
+    lanes qy = lanesCross(tz, e1x, tx, e1z);
+    lanes qz = lanesCross(tx, e1y, ty, e1x);
+    lanes v = lanesMul(lanesDot(dx, dy, dz, qx, qy, qz), inverse);
+    lanes t = lanesMul(lanesDot(e2x, e2y, e2z, qx, qy, qz), inverse);
+
+    lanes hit = lanesOr(lanesLess(det, negativeEpsilon), lanesLess(epsilon, det));
+    hit = lanesAnd(hit, lanesAnd(lanesLessEqual(zero, u), lanesLessEqual(u, one)));
+    hit = lanesAnd(hit, lanesAnd(lanesLessEqual(zero, v), lanesLessEqual(lanesAdd(u, v), one)));
+    hit = lanesAnd(hit, lanesAnd(lanesLess(epsilon, t), lanesLess(t, lanesSet(nearest))));
+    int mask = lanesMask(hit);
+    if (mask == 0) continue;
+
+    float distances[4];
+    lanesStore(distances, t);
+    for (int k = 0; k < 4; k++) {
+      if ((mask & (1 << k)) && distances[k] < nearest) {
+        nearest = distances[k];
+        nearestTriangle = 4*i + k;
+      }
+    }
+  }
+
   RayCollision collision = { 0 };
+  if (nearestTriangle < 0) return collision;
+  const trianglePacket* p = &packets[nearestTriangle/4];
+  int k = nearestTriangle%4;
+  collision.hit = true;
+  collision.distance = nearest;
+  collision.point = Vector3Add(ray.position, Vector3Scale(ray.direction, nearest));
+  collision.normal = Vector3Normalize(Vector3CrossProduct((Vector3){ p->e1x[k], p->e1y[k], p->e1z[k] }, (Vector3){ p->e2x[k], p->e2y[k], p->e2z[k] }));
+  return collision;
+}
+
+// what the player collides with in place of a model: everything it shows merged into one mesh in world space and
+// simplified, plus bounds to skip it whole; the meshes have to fit 16 bit indices together
+#define COLLISION_MAX_ERROR 0.1f // furthest a proxy may stray from the model, in world units
 
+typedef struct {
+  Mesh mesh; // CPU only
+  BoundingBox bounds;
+  trianglePacket* packets; // the mesh's triangles again, laid out for queries
+  int packetCount;
+} collisionProxy;
+
+// ratio is the share of the triangles to aim for
+collisionProxy loadCollisionProxy(Model model, float ratio, const char* name) {
+  Mesh merged = { 0 };
   for (int i = 0; i < model.meshCount; i++) {
-    RayCollision newCollision = GetRayCollisionMesh(ray, model.meshes[i], model.transform);
-    if (newCollision.hit && (!collision.hit || collision.distance > newCollision.distance)) {
-      collision = newCollision;
+    if (model.meshes[i].triangleCount == 0) continue;
+    merged.vertexCount += model.meshes[i].vertexCount;
+    merged.triangleCount += model.meshes[i].triangleCount;
+  }
+  merged.vertices = (float*)MemAlloc(merged.vertexCount*3*sizeof(float));
+  merged.indices = (unsigned short*)MemAlloc(merged.triangleCount*3*sizeof(unsigned short));
+  int vertexCount = 0, indexCount = 0;
+  for (int i = 0; i < model.meshCount; i++) {
+    const Mesh* mesh = &model.meshes[i];
+    if (mesh->triangleCount == 0) continue;
+    for (int v = 0; v < mesh->vertexCount; v++) {
+      Vector3 p = Vector3Transform(lodPosition(mesh, v), model.transform);
+      memcpy(&merged.vertices[3*(vertexCount + v)], &p, sizeof(p));
     }
+    for (int k = 0; k < 3*mesh->triangleCount; k++) {
+      merged.indices[indexCount++] = (unsigned short)(vertexCount + (mesh->indices != NULL ? mesh->indices[k] : k));
+    }
+    vertexCount += mesh->vertexCount;
   }
 
-  return collision;
+  collisionProxy proxy = { 0 };
+  unsigned short* indices = (unsigned short*)MemAlloc(merged.triangleCount*3*sizeof(unsigned short));
+  float error;
+  Mesh simplified = merged;
+  simplified.indices = indices;
+  simplified.triangleCount = simplifyMesh(&merged, indices, (int)(ratio*merged.triangleCount), COLLISION_MAX_ERROR, &error);
+  if (optimizeMesh(&simplified, &proxy.mesh, TextFormat("%s collision", name))) unloadMeshArrays(&merged);
+  else proxy.mesh = merged;
+  MemFree(indices);
+  proxy.bounds = GetMeshBoundingBox(proxy.mesh);
+  proxy.packets = loadTrianglePackets(&proxy.mesh, &proxy.packetCount);
+  return proxy;
 }
 
-RayCollision playerCollision(Ray ray, Vector3 offsets[], int offsetCount, Model objects[], int objectCount) {
-  RayCollision collision = { 0 };
-  Vector3 originalPosition = ray.position;
+void unloadCollisionProxy(collisionProxy* proxy) {
+  // only uploaded when it's drawn for picking
+  if (proxy->mesh.vaoId > 0) UnloadMesh(proxy->mesh);
+  else unloadMeshArrays(&proxy->mesh);
+  MemFree(proxy->packets);
+}
+
+RayCollision proxyRayCollision(Ray ray, const collisionProxy* proxy) {
+  if (!GetRayCollisionBox(ray, proxy->bounds).hit) return (RayCollision){ 0 };
+  return packetRayCollision(ray, proxy->packets, proxy->packetCount);
+}
+
+#define INTERACT_TARGETS 8 // most things that can be registered for interacting with
+#define INTERACT_REACH 8.0f // how far away something can be interacted with
+
+typedef enum { INTERACT_JUKEBOX, INTERACT_CANVAS } interaction;
+
+typedef struct {
+  interaction kind;
+  const collisionProxy* proxy;
+  Vector3 center; // bounding sphere, so most targets are turned away before any triangle
+  float radius;
+} interactTarget;
+
+typedef struct {
+  interactTarget targets[INTERACT_TARGETS];
+  int count;
+} interactRegistry;
+
+void addInteractTarget(interactRegistry* registry, interaction kind, const collisionProxy* proxy) {
+  if (registry->count == INTERACT_TARGETS) {
+    TraceLog(LOG_WARNING, "INTERACT: No room for more than %i targets", INTERACT_TARGETS);
+    return;
+  }
+  BoundingBox box = proxy->bounds;
+  registry->targets[registry->count++] = (interactTarget){
+    kind, proxy, Vector3Scale(Vector3Add(box.min, box.max), 0.5f), Vector3Distance(box.min, box.max)/2
+  };
+}
+
+// the nearest target the ray hits within reach, or NULL
+// targets are tried in the order the ray enters their spheres, so the search stops at the first sphere past a hit
+const interactTarget* queryInteractTargets(const interactRegistry* registry, Ray ray, float reach) {
+  int order[INTERACT_TARGETS];
+  float enter[INTERACT_TARGETS];
+  int candidates = 0;
+  for (int i = 0; i < registry->count; i++) {
+    const interactTarget* target = &registry->targets[i];
+    Vector3 m = Vector3Subtract(ray.position, target->center);
+    float b = Vector3DotProduct(m, ray.direction);
+    float c = Vector3DotProduct(m, m) - target->radius*target->radius;
+    float discriminant = b*b - c;
+    if (discriminant < 0 || (c > 0 && b > 0)) continue;
+    float distance = fmaxf(-b - sqrtf(discriminant), 0);
+    if (distance >= reach) continue;
+
+    int j = candidates++;
+    for (; j > 0 && enter[j - 1] > distance; j--) {
+      order[j] = order[j - 1];
+      enter[j] = enter[j - 1];
+    }
+    order[j] = i;
+    enter[j] = distance;
+  }
+
+  const interactTarget* nearest = NULL;
+  for (int j = 0; j < candidates && enter[j] < reach; j++) {
+    RayCollision collision = proxyRayCollision(ray, registry->targets[order[j]].proxy);
+    if (collision.hit && collision.distance < reach) {
+      nearest = &registry->targets[order[j]];
+      reach = collision.distance;
+    }
+  }
+  return nearest;
+}
+
+#define PICK_FRAMES 3 // one pixel targets drawn in turn, each read back PICK_FRAMES - 1 frames later when the GPU is long done with it
+#define PICK_RANGE 64.0f // furthest distance a pick can tell apart
+
+typedef struct {
+  Mesh mesh;
+  Matrix transform;
+  bool uv; // reports texture coordinates instead of distance
+} pickable;
+
+typedef struct {
+  int pass; // as given when it was drawn, so results from another kind of pass can be told apart
+  int id; // 1 + index of the pickable under the pixel, 0 for nothing
+  Vector2 uv;
+  float distance;
+} pickResult;
+
+typedef struct {
+  Material material;
+  int idLoc;
+  int rangeLoc;
+  RenderTexture2D targets[PICK_FRAMES];
+  int passes[PICK_FRAMES];
+  int current;
+  int drawn; // up to PICK_FRAMES, results start once every target has been drawn
+} picker;
+
+picker loadPicker(void) {
+  picker p = { 0 };
+  p.material = LoadMaterialDefault();
+  p.material.shader = LoadShader(TextFormat("assets/shaders/glsl%i/pick.vs", GLSL_VERSION), TextFormat("assets/shaders/glsl%i/pick.fs", GLSL_VERSION));
+  p.idLoc = GetShaderLocation(p.material.shader, "pickId");
+  p.rangeLoc = GetShaderLocation(p.material.shader, "pickRange");
+  for (int i = 0; i < PICK_FRAMES; i++) p.targets[i] = LoadRenderTexture(1, 1);
+  return p;
+}
+
+void unloadPicker(picker* p) {
+  for (int i = 0; i < PICK_FRAMES; i++) UnloadRenderTexture(p->targets[i]);
+  UnloadMaterial(p->material);
+}
+
+// draws the items as seen through one pixel of the screen, and returns what the pass from PICK_FRAMES - 1 frames ago saw
+pickResult updatePicker(picker* p, Camera camera, Vector2 pixel, int pass, const pickable items[], int count) {
+  float width = GetScreenWidth(), height = GetScreenHeight();
+  Matrix projection = MatrixPerspective(camera.fovy*DEG2RAD, width/height, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+  // scales the pixel's square of clip space up to the whole target
+  Vector2 center = { 2*pixel.x/width - 1, 1 - 2*pixel.y/height };
+  Matrix zoom = MatrixIdentity();
+  zoom.m0 = width;
+  zoom.m5 = height;
+  zoom.m12 = -width*center.x;
+  zoom.m13 = -height*center.y;
+
+  BeginTextureMode(p->targets[p->current]);
+    ClearBackground(BLANK);
+    BeginMode3D(camera);
+      // in place of the one BeginMode3D fit to the target
+      rlSetMatrixProjection(MatrixMultiply(projection, zoom));
+      rlDisableColorBlend();
+      rlDisableBackfaceCulling();
+      for (int i = 0; i < count; i++) {
+        float id = i + 1;
+        float range = items[i].uv ? 0 : PICK_RANGE;
+        SetShaderValue(p->material.shader, p->idLoc, &id, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(p->material.shader, p->rangeLoc, &range, SHADER_UNIFORM_FLOAT);
+        DrawMesh(items[i].mesh, p->material, items[i].transform);
+      }
+      rlEnableBackfaceCulling();
+      rlEnableColorBlend();
+    EndMode3D();
+  EndTextureMode();
+  p->passes[p->current] = pass;
+  if (p->drawn < PICK_FRAMES) p->drawn++;
+  p->current = (p->current + 1)%PICK_FRAMES;
+
+  // the next target to be drawn over is the oldest
+  pickResult result = { 0 };
+  if (p->drawn < PICK_FRAMES) return result;
+  RenderTexture2D oldest = p->targets[p->current];
+  unsigned char* rgba = (unsigned char*)rlReadTexturePixels(oldest.texture.id, 1, 1, oldest.texture.format);
+  if (rgba == NULL) return result;
+  int x = rgba[0] << 4 | rgba[1] >> 4;
+  int y = (rgba[1] & 15) << 8 | rgba[2];
+  result.pass = p->passes[p->current];
+  result.id = rgba[3];
+  result.uv = (Vector2){ x/4095.0f, y/4095.0f };
+  result.distance = PICK_RANGE*x/4095.0f;
+  MemFree(rgba);
+  return result;
+}
+
+#define PLAYER_RADIUS 1.5f
+#define PLAYER_HEIGHT 7.0f // eye height above whatever the player stands on
+#define PLAYER_SLIDES 3 // surfaces slid along in one step before the rest of the move is given up
+#define PLAYER_SKIN 0.01f // gap kept from surfaces so the next sweep doesn't start touching them
+
+// the player is a pair of overlapping spheres, at the eye and below it, standing in for a capsule
+Vector3 playerSpheres[] = { { 0, 0, 0 }, { 0, -2, 0 } };
+#define PLAYER_SPHERES (int)(sizeof(playerSpheres)/sizeof(playerSpheres[0]))
+
+typedef struct {
+  Vector3 position; // the eye after the last tick
+  Vector3 previous; // the eye a tick before, frames in between are drawn between the two
+  Vector3* nearby; // corners of the triangles the current step can reach, so each slide doesn't search every proxy
+  int nearbyCount;
+  int nearbyCapacity;
+} player;
+
+// t is the share of the motion before touching, only replaced by an earlier touch
+bool sweepSpherePoint(Vector3 center, Vector3 motion, float radius, Vector3 p, float* t, Vector3* normal) {
+  Vector3 m = Vector3Subtract(center, p);
+  float b = Vector3DotProduct(m, motion);
+  float c = Vector3DotProduct(m, m) - radius*radius;
+  if (b >= 0) return false; // moving away
+  if (c < 0) {
+    // already touching
+    *t = 0;
+    *normal = Vector3Normalize(m);
+    return true;
+  }
+  float a = Vector3DotProduct(motion, motion);
+  float discriminant = b*b - a*c;
+  if (discriminant < 0) return false;
+  float s = (-b - sqrtf(discriminant))/a;
+  if (s > *t) return false;
+  *t = s;
+  *normal = Vector3Normalize(Vector3Add(m, Vector3Scale(motion, s)));
+  return true;
+}
+
+// against the side of the capsule around the segment, the ends are left to sweepSpherePoint
+bool sweepSphereSegment(Vector3 center, Vector3 motion, float radius, Vector3 p, Vector3 q, float* t, Vector3* normal) {
+  Vector3 e = Vector3Subtract(q, p);
+  Vector3 m = Vector3Subtract(center, p);
+  float ee = Vector3DotProduct(e, e);
+  float me = Vector3DotProduct(m, e);
+  float de = Vector3DotProduct(motion, e);
+  float a = ee*Vector3DotProduct(motion, motion) - de*de;
+  float b = ee*Vector3DotProduct(m, motion) - me*de;
+  float c = ee*(Vector3DotProduct(m, m) - radius*radius) - me*me;
+  if (b >= 0 || a <= 0) return false; // moving away from or along the segment
+  float s = 0;
+  if (c >= 0) {
+    float discriminant = b*b - a*c;
+    if (discriminant < 0) return false;
+    s = (-b - sqrtf(discriminant))/a;
+    if (s > *t) return false;
+  }
+  float u = me + s*de;
+  if (u < 0 || u > ee) return false;
+  *t = s;
+  *normal = Vector3Normalize(Vector3Subtract(Vector3Add(m, Vector3Scale(motion, s)), Vector3Scale(e, u/ee)));
+  return true;
+}
+
+bool sweepSphereTriangle(Vector3 center, Vector3 motion, float radius, Vector3 a, Vector3 b, Vector3 c, float* t, Vector3* normal) {
+  Vector3 face = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(b, a), Vector3Subtract(c, a)));
+  float distance = Vector3DotProduct(Vector3Subtract(center, a), face);
+  // either side of a triangle can be hit
+  Vector3 n = distance < 0 ? Vector3Negate(face) : face;
+  distance = fabsf(distance);
+  float approach = -Vector3DotProduct(motion, n);
+  if (distance - radius > fmaxf(approach, 0)) return false; // never reaches the plane
+
+  // the face: if the sphere first touches the plane inside the triangle nothing else can be touched sooner
+  if (approach > 0) {
+    float s = fmaxf((distance - radius)/approach, 0);
+    if (s > *t) return false;
+    Vector3 contact = Vector3Subtract(Vector3Add(center, Vector3Scale(motion, s)), Vector3Scale(n, distance - s*approach));
+    Vector3 ca = Vector3Subtract(a, contact), cb = Vector3Subtract(b, contact), cc = Vector3Subtract(c, contact);
+    if (Vector3DotProduct(Vector3CrossProduct(ca, cb), face) >= 0 && Vector3DotProduct(Vector3CrossProduct(cb, cc), face) >= 0 && Vector3DotProduct(Vector3CrossProduct(cc, ca), face) >= 0) {
+      *t = s;
+      *normal = n;
+      return true;
+    }
+  }
+
+  bool hit = false;
+  hit |= sweepSphereSegment(center, motion, radius, a, b, t, normal);
+  hit |= sweepSphereSegment(center, motion, radius, b, c, t, normal);
+  hit |= sweepSphereSegment(center, motion, radius, c, a, t, normal);
+  hit |= sweepSpherePoint(center, motion, radius, a, t, normal);
+  hit |= sweepSpherePoint(center, motion, radius, b, t, normal);
+  hit |= sweepSpherePoint(center, motion, radius, c, t, normal);
+  return hit;
+}
+
+void unloadPlayer(player* body) {
+  MemFree(body->nearby);
+  body->nearby = NULL;
+  body->nearbyCount = body->nearbyCapacity = 0;
+}
 
-  for (int i = 0; i < offsetCount; i++) {
-    ray.position = Vector3Add(originalPosition, offsets[i]);
-    for (int j = 0; j < objectCount; j++) {
-      RayCollision newCollision = GetRayCollisionModel(ray, objects[j]);
-      if (newCollision.hit && (!collision.hit || collision.distance > newCollision.distance)) {
-        collision = newCollision;
+// collects the triangles whose bounds touch the box, four at a time
+void gatherPlayerTriangles(player* body, BoundingBox reach, const collisionProxy objects[], int objectCount) {
+  lanes minX = lanesSet(reach.min.x), minY = lanesSet(reach.min.y), minZ = lanesSet(reach.min.z);
+  lanes maxX = lanesSet(reach.max.x), maxY = lanesSet(reach.max.y), maxZ = lanesSet(reach.max.z);
+  body->nearbyCount = 0;
+  for (int j = 0; j < objectCount; j++) {
+    if (!CheckCollisionBoxes(reach, objects[j].bounds)) continue;
+    for (int i = 0; i < objects[j].packetCount; i++) {
+      const trianglePacket* p = &objects[j].packets[i];
+      lanes ax = lanesLoad(p->ax), ay = lanesLoad(p->ay), az = lanesLoad(p->az);
+      lanes bx = lanesAdd(ax, lanesLoad(p->e1x)), by = lanesAdd(ay, lanesLoad(p->e1y)), bz = lanesAdd(az, lanesLoad(p->e1z));
+      lanes cx = lanesAdd(ax, lanesLoad(p->e2x)), cy = lanesAdd(ay, lanesLoad(p->e2y)), cz = lanesAdd(az, lanesLoad(p->e2z));
+      lanes touching = lanesAnd(lanesLessEqual(lanesMin(ax, lanesMin(bx, cx)), maxX), lanesLessEqual(minX, lanesMax(ax, lanesMax(bx, cx))));
+      touching = lanesAnd(touching, lanesAnd(lanesLessEqual(lanesMin(ay, lanesMin(by, cy)), maxY), lanesLessEqual(minY, lanesMax(ay, lanesMax(by, cy)))));
+      touching = lanesAnd(touching, lanesAnd(lanesLessEqual(lanesMin(az, lanesMin(bz, cz)), maxZ), lanesLessEqual(minZ, lanesMax(az, lanesMax(bz, cz)))));
+      int mask = lanesMask(touching);
+      for (int k = 0; k < 4; k++) {
+        if (!(mask & (1 << k))) continue;
+        if (body->nearbyCount == body->nearbyCapacity) {
+          body->nearbyCapacity = body->nearbyCapacity == 0 ? 64 : 2*body->nearbyCapacity;
+          body->nearby = (Vector3*)MemRealloc(body->nearby, body->nearbyCapacity*3*sizeof(Vector3));
+        }
+        packetCorners(p, k, &body->nearby[3*body->nearbyCount++]);
       }
     }
   }
+}
+
+bool playerSweep(const player* body, Vector3 motion, float* t, Vector3* normal) {
+  bool hit = false;
+  for (int i = 0; i < PLAYER_SPHERES; i++) {
+    Vector3 center = Vector3Add(body->position, playerSpheres[i]);
+    for (int j = 0; j < body->nearbyCount; j++) {
+      const Vector3* corners = &body->nearby[3*j];
+      hit |= sweepSphereTriangle(center, motion, PLAYER_RADIUS, corners[0], corners[1], corners[2], t, normal);
+    }
+  }
+  return hit;
+}
 
+RayCollision playerGround(Vector3 position, const collisionProxy objects[], int objectCount) {
+  RayCollision collision = { 0 };
+  for (int i = 0; i < objectCount; i++) {
+    RayCollision newCollision = proxyRayCollision((Ray){ position, (Vector3){ 0, -1, 0 } }, &objects[i]);
+    if (newCollision.hit && (!collision.hit || collision.distance > newCollision.distance)) {
+      collision = newCollision;
+    }
+  }
   return collision;
 }
 
-Ray RayTransform(Ray r, Matrix mat) {
-  Vector3 position = Vector3Transform(r.position, mat);
-  r.direction = Vector3Normalize(Vector3Subtract(Vector3Transform(Vector3Add(r.position, r.direction), mat), position));
-  r.position = position;
-  return r;
+// where the keys are walking, in world units per second along the ground
+Vector3 playerVelocity(Camera3D* camera) {
+  Vector3 forward = GetCameraForward(camera);
+  Vector3 right = GetCameraRight(camera);
+  forward.y = right.y = 0;
+  forward = Vector3Normalize(forward);
+  right = Vector3Normalize(right);
+
+  Vector3 velocity = { 0 };
+  if (IsKeyDown(KEY_W)) velocity = Vector3Add(velocity, forward);
+  if (IsKeyDown(KEY_A)) velocity = Vector3Subtract(velocity, right);
+  if (IsKeyDown(KEY_S)) velocity = Vector3Subtract(velocity, forward);
+  if (IsKeyDown(KEY_D)) velocity = Vector3Add(velocity, right);
+  return Vector3Scale(velocity, 15);
 }
 
-void playerPhysics(Camera3D* camera, Vector3 oldPos, Model objects[], int objectCount, Model ladder) {
-  Vector3 offsets[2] = { { 0, 0, 0 }, { 0, -2, 0 } };
-  int offsetCount = sizeof(offsets)/sizeof(Vector3);
-  Vector3 movement = Vector3Subtract(camera->position, oldPos);
+// the ladder is climbed and landed on from where the feet are
+Vector3 playerFeet(const player* body) {
+  return Vector3Subtract(body->position, (Vector3){ 0, PLAYER_HEIGHT, 0 });
+}
 
-  RayCollision collision = GetRayCollisionBox(RayTransform((Ray){ Vector3Subtract(camera->position, (Vector3){ 0, 7, 0 }), movement }, MatrixInvert(ladder.transform)), GetMeshBoundingBox(ladder.meshes[0]));
-  bool climbing = collision.hit && collision.distance < 10;
+// one tick: climb the ladder if walking into it, otherwise slide along what's hit, then fall
+// the ladder is a box in its own space
+void playerStep(player* body, Vector3 velocity, const collisionProxy objects[], int objectCount, Matrix ladderTransform, BoundingBox ladderBounds) {
+  Vector3 movement = Vector3Scale(velocity, TICK_SECONDS);
+  Matrix ladderInverse = MatrixInvert(ladderTransform);
+  body->previous = body->position;
+
+  if (Vector3LengthSqr(movement) > 0) {
+    RayCollision collision = GetRayCollisionBox(RayTransform((Ray){ playerFeet(body), movement }, ladderInverse), ladderBounds);
+    if (collision.hit && collision.distance < 10) {
+      body->position.y += 12*TICK_SECONDS;
+      return;
+    }
+  }
 
-  if (climbing) {
-    camera->position = oldPos;
-    camera->position.y += 12*GetFrameTime();
-  } else {
-    collision = playerCollision((Ray){ oldPos, movement }, offsets, offsetCount, objects, objectCount);
-    if (collision.hit && collision.distance <= 2) {
-      if (collision.normal.y < 0) collision.normal.y = 0;
-      Vector3 newPos = Vector3Add(oldPos, Vector3Reject(movement, collision.normal));
-      camera->target = Vector3Add(camera->target, Vector3Subtract(newPos, camera->position));
-      camera->position = newPos;
+  // sliding only ever shortens the move, so nothing outside its reach from here can be hit this step
+  float r = PLAYER_RADIUS + Vector3Length(movement);
+  BoundingBox box = { body->position, body->position };
+  for (int i = 0; i < PLAYER_SPHERES; i++) {
+    box.min = Vector3Min(box.min, Vector3Add(body->position, playerSpheres[i]));
+    box.max = Vector3Max(box.max, Vector3Add(body->position, playerSpheres[i]));
+  }
+  box.min = Vector3Subtract(box.min, (Vector3){ r, r, r });
+  box.max = Vector3Add(box.max, (Vector3){ r, r, r });
+  gatherPlayerTriangles(body, box, objects, objectCount);
+
+  for (int i = 0; i < PLAYER_SLIDES && Vector3LengthSqr(movement) > 0; i++) {
+    float t = 1;
+    Vector3 normal;
+    if (!playerSweep(body, movement, &t, &normal)) {
+      body->position = Vector3Add(body->position, movement);
+      break;
+    }
+    float length = Vector3Length(movement);
+    body->position = Vector3Add(body->position, Vector3Scale(movement, fmaxf(t*length - PLAYER_SKIN, 0)/length));
+    // don't get pushed into the floor by what's overhead
+    if (normal.y < 0) normal.y = 0;
+    if (Vector3LengthSqr(normal) == 0) break;
+    movement = Vector3Reject(Vector3Scale(movement, 1 - t), Vector3Normalize(normal));
+  }
+
+  RayCollision ground = playerGround(body->position, objects, objectCount);
+  if (ground.hit && ground.distance >= PLAYER_HEIGHT && !CheckCollisionBoxSphere(ladderBounds, Vector3Transform(playerFeet(body), ladderInverse), 20)) {
+    // stop on the ground rather than in it
+    body->position.y -= fminf(40*TICK_SECONDS, ground.distance - PLAYER_HEIGHT);
+  }
+}
+
+// alpha is how far the frame is from the last tick to the next one
+void placePlayerCamera(const player* body, Camera3D* camera, float alpha) {
+  Vector3 eye = Vector3Lerp(body->previous, body->position, alpha);
+  camera->target = Vector3Add(camera->target, Vector3Subtract(eye, camera->position));
+  camera->position = eye;
+}
 
-      movement = Vector3Subtract(camera->position, oldPos);
-      collision = playerCollision((Ray){ oldPos, movement }, offsets, offsetCount, objects, objectCount);
-      if (collision.hit && collision.distance <= 2) {
-        camera->target = Vector3Add(camera->target, Vector3Subtract(oldPos, camera->position));
-        camera->position = oldPos;
+// the camera's view volume as six planes facing inwards, for skipping what's off screen
+typedef struct {
+  Vector4 planes[6];
+} frustum;
+
+// what culling saved this frame, in draw calls
+typedef struct {
+  int drawn;
+  int culled;
+} cullStats;
+
+// planes from the rows of the view-projection matrix (Gribb & Hartmann)
+frustum loadFrustum(Matrix viewProjection) {
+  Matrix m = viewProjection;
+  Vector4 x = { m.m0, m.m4, m.m8, m.m12 };
+  Vector4 y = { m.m1, m.m5, m.m9, m.m13 };
+  Vector4 z = { m.m2, m.m6, m.m10, m.m14 };
+  Vector4 w = { m.m3, m.m7, m.m11, m.m15 };
+  frustum f = { {
+    Vector4Add(w, x), Vector4Subtract(w, x),
+    Vector4Add(w, y), Vector4Subtract(w, y),
+    Vector4Add(w, z), Vector4Subtract(w, z),
+  } };
+  return f;
+}
+
+// conservative: a box that straddles two planes outside a corner still counts as visible
+bool boxInFrustum(const frustum* f, BoundingBox box) {
+  for (int i = 0; i < 6; i++) {
+    Vector4 p = f->planes[i];
+    // the corner furthest along the plane's normal
+    float x = p.x > 0 ? box.max.x : box.min.x;
+    float y = p.y > 0 ? box.max.y : box.min.y;
+    float z = p.z > 0 ? box.max.z : box.min.z;
+    if (p.x*x + p.y*y + p.z*z + p.w < 0) return false;
+  }
+  return true;
+}
+
+BoundingBox transformBoundingBox(BoundingBox box, Matrix transform) {
+  BoundingBox out = { { INFINITY, INFINITY, INFINITY }, { -INFINITY, -INFINITY, -INFINITY } };
+  for (int i = 0; i < 8; i++) {
+    Vector3 corner = { i & 1 ? box.max.x : box.min.x, i & 2 ? box.max.y : box.min.y, i & 4 ? box.max.z : box.min.z };
+    corner = Vector3Transform(corner, transform);
+    out.min = Vector3Min(out.min, corner);
+    out.max = Vector3Max(out.max, corner);
+  }
+  return out;
+}
+
+// bounds of each mesh in model space, computed once so moving models only transform 8 corners a frame
+BoundingBox* loadMeshBounds(Model model) {
+  BoundingBox* bounds = (BoundingBox*)MemAlloc(model.meshCount*sizeof(BoundingBox));
+  for (int i = 0; i < model.meshCount; i++) bounds[i] = GetMeshBoundingBox(model.meshes[i]);
+  return bounds;
+}
+
+// DrawModel, skipping meshes outside the frustum
+void drawModelCulled(Model model, const BoundingBox* bounds, Vector3 position, float scale, Color tint, const frustum* f, cullStats* stats) {
+  Matrix transform = MatrixMultiply(MatrixMultiply(model.transform, MatrixScale(scale, scale, scale)), MatrixTranslate(position.x, position.y, position.z));
+  for (int i = 0; i < model.meshCount; i++) {
+    Material* material = &model.materials[model.meshMaterial[i]];
+    // hidden by a clear colour, like the pole's line and hook once cast; drawn, it would still write depth and leave a
+    // hole where the sky is drawn last
+    if (material->maps[MATERIAL_MAP_DIFFUSE].color.a == 0 || tint.a == 0) continue;
+    if (!boxInFrustum(f, transformBoundingBox(bounds[i], transform))) {
+      stats->culled++;
+      continue;
+    }
+    stats->drawn++;
+    Color color = material->maps[MATERIAL_MAP_DIFFUSE].color;
+    material->maps[MATERIAL_MAP_DIFFUSE].color = (Color){
+      (unsigned char)(color.r*tint.r/255), (unsigned char)(color.g*tint.g/255),
+      (unsigned char)(color.b*tint.b/255), (unsigned char)(color.a*tint.a/255)
+    };
+    DrawMesh(model.meshes[i], *material, transform);
+    material->maps[MATERIAL_MAP_DIFFUSE].color = color;
+  }
+}
+
+// scenery that never moves, merged at load into a mesh per shader, texture and culling mode with the transforms baked
+// in, so it costs a handful of draw calls instead of one per mesh of every model; meshes only merge within a cell of a
+// coarse grid, so what's behind the camera can still be culled
+#define BATCH_MAX_VERTICES 65535 // indices are 16 bit, a bigger mesh gets a batch of its own without them
+#define BATCH_CELL 32.0f
+
+typedef struct {
+  Mesh mesh;
+  Material material; // only the shader and diffuse texture, the colour is in the vertices
+  bool doubleSided;
+  int cell[3]; // grid cell holding the centres of its meshes
+  BoundingBox bounds;
+  Mesh lods[LOD_LEVELS - 1]; // coarser and coarser
+  float lodErrors[LOD_LEVELS - 1];
+  int lodCount;
+} staticBatch;
+
+typedef struct {
+  staticBatch* batches;
+  int count;
+} staticScene;
+
+bool staticBatchBefore(const staticBatch* a, const staticBatch* b) {
+  if (a->material.shader.id != b->material.shader.id) return a->material.shader.id < b->material.shader.id;
+  if (a->material.maps[MATERIAL_MAP_DIFFUSE].texture.id != b->material.maps[MATERIAL_MAP_DIFFUSE].texture.id) {
+    return a->material.maps[MATERIAL_MAP_DIFFUSE].texture.id < b->material.maps[MATERIAL_MAP_DIFFUSE].texture.id;
+  }
+  return a->doubleSided < b->doubleSided;
+}
+
+// merges the models, which stay loaded for collisions; meshes with no triangles (hidden ones) are left out
+staticScene loadStaticScene(const Model models[], const bool doubleSided[], int count) {
+  int meshCount = 0;
+  for (int m = 0; m < count; m++) meshCount += models[m].meshCount;
+  staticScene scene = { (staticBatch*)MemAlloc(meshCount*sizeof(staticBatch)), 0 };
+  int* batchOf = (int*)MemAlloc(meshCount*sizeof(int));
+
+  // which batch each mesh goes to, and how big the batches get
+  for (int m = 0, n = 0; m < count; m++) {
+    for (int i = 0; i < models[m].meshCount; i++, n++) {
+      const Mesh* mesh = &models[m].meshes[i];
+      Material* material = &models[m].materials[models[m].meshMaterial[i]];
+      batchOf[n] = -1;
+      if (mesh->triangleCount == 0) continue;
+      BoundingBox bounds = transformBoundingBox(GetMeshBoundingBox(*mesh), models[m].transform);
+      Vector3 centre = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+      int cell[3] = { (int)floorf(centre.x/BATCH_CELL), (int)floorf(centre.y/BATCH_CELL), (int)floorf(centre.z/BATCH_CELL) };
+      for (int b = 0; b < scene.count && batchOf[n] < 0; b++) {
+        staticBatch* batch = &scene.batches[b];
+        if (batch->material.shader.id == material->shader.id &&
+            batch->material.maps[MATERIAL_MAP_DIFFUSE].texture.id == material->maps[MATERIAL_MAP_DIFFUSE].texture.id &&
+            batch->doubleSided == doubleSided[m] && memcmp(batch->cell, cell, sizeof(cell)) == 0 &&
+            batch->mesh.vertexCount + mesh->vertexCount <= BATCH_MAX_VERTICES) {
+          batchOf[n] = b;
+        }
+      }
+      if (batchOf[n] < 0) {
+        batchOf[n] = scene.count++;
+        staticBatch* batch = &scene.batches[batchOf[n]];
+        *batch = (staticBatch){ 0 };
+        batch->material = LoadMaterialDefault();
+        batch->material.shader = material->shader;
+        batch->material.maps[MATERIAL_MAP_DIFFUSE].texture = material->maps[MATERIAL_MAP_DIFFUSE].texture;
+        batch->doubleSided = doubleSided[m];
+        memcpy(batch->cell, cell, sizeof(cell));
       }
+      scene.batches[batchOf[n]].mesh.vertexCount += mesh->vertexCount;
+      scene.batches[batchOf[n]].mesh.triangleCount += mesh->triangleCount;
     }
+  }
+  for (int b = 0; b < scene.count; b++) {
+    Mesh* mesh = &scene.batches[b].mesh;
+    mesh->vertices = (float*)MemAlloc(mesh->vertexCount*3*sizeof(float));
+    mesh->normals = (float*)MemAlloc(mesh->vertexCount*3*sizeof(float));
+    mesh->texcoords = (float*)MemAlloc(mesh->vertexCount*2*sizeof(float));
+    mesh->colors = (unsigned char*)MemAlloc(mesh->vertexCount*4);
+    if (mesh->vertexCount <= BATCH_MAX_VERTICES) {
+      mesh->indices = (unsigned short*)MemAlloc(mesh->triangleCount*3*sizeof(unsigned short));
+    }
+    mesh->vertexCount = 0;
+    mesh->triangleCount = 0;
+  }
 
-    collision = playerCollision((Ray){ camera->position, (Vector3){ 0, -1, 0 } }, offsets, 1, objects, objectCount);
-    if (collision.hit && collision.distance >= 7 && !CheckCollisionBoxSphere(GetMeshBoundingBox(ladder.meshes[0]), Vector3Transform(Vector3Subtract(camera->position, (Vector3){ 0, 7, 0 }), MatrixInvert(ladder.transform)), 20)) {
-      float fall = 40*GetFrameTime();
-      camera->position.y -= fall;
-      camera->target.y -= fall;
+  // fill them in world space
+  for (int m = 0, n = 0; m < count; m++) {
+    Matrix transform = models[m].transform;
+    Matrix normalTransform = MatrixTranspose(MatrixInvert(transform));
+    for (int i = 0; i < models[m].meshCount; i++, n++) {
+      if (batchOf[n] < 0) continue;
+      const Mesh* src = &models[m].meshes[i];
+      Color color = models[m].materials[models[m].meshMaterial[i]].maps[MATERIAL_MAP_DIFFUSE].color;
+      Mesh* dst = &scene.batches[batchOf[n]].mesh;
+      int first = dst->vertexCount;
+      for (int v = 0; v < src->vertexCount; v++) {
+        int d = first + v;
+        Vector3 p = Vector3Transform((Vector3){ src->vertices[3*v], src->vertices[3*v+1], src->vertices[3*v+2] }, transform);
+        dst->vertices[3*d] = p.x;
+        dst->vertices[3*d+1] = p.y;
+        dst->vertices[3*d+2] = p.z;
+        Vector3 normal = { 0, 1, 0 };
+        if (src->normals != NULL) {
+          normal = Vector3Normalize(Vector3Transform((Vector3){ src->normals[3*v], src->normals[3*v+1], src->normals[3*v+2] }, normalTransform));
+        }
+        dst->normals[3*d] = normal.x;
+        dst->normals[3*d+1] = normal.y;
+        dst->normals[3*d+2] = normal.z;
+        dst->texcoords[2*d] = src->texcoords != NULL ? src->texcoords[2*v] : 0;
+        dst->texcoords[2*d+1] = src->texcoords != NULL ? src->texcoords[2*v+1] : 0;
+        unsigned char own[4] = { 255, 255, 255, 255 };
+        const unsigned char* c = src->colors != NULL ? &src->colors[4*v] : own;
+        dst->colors[4*d] = (unsigned char)(c[0]*color.r/255);
+        dst->colors[4*d+1] = (unsigned char)(c[1]*color.g/255);
+        dst->colors[4*d+2] = (unsigned char)(c[2]*color.b/255);
+        dst->colors[4*d+3] = (unsigned char)(c[3]*color.a/255);
+      }
+      for (int k = 0; k < src->triangleCount*3 && dst->indices != NULL; k++) {
+        dst->indices[3*dst->triangleCount + k] = (unsigned short)(first + (src->indices != NULL ? src->indices[k] : k));
+      }
+      dst->vertexCount += src->vertexCount;
+      dst->triangleCount += src->triangleCount;
+    }
+  }
+  MemFree(batchOf);
+
+  // sorted so consecutive draws share as much state as they can
+  for (int b = 1; b < scene.count; b++) {
+    staticBatch batch = scene.batches[b];
+    int c = b;
+    for (; c > 0 && staticBatchBefore(&batch, &scene.batches[c-1]); c--) scene.batches[c] = scene.batches[c-1];
+    scene.batches[c] = batch;
+  }
+  for (int b = 0; b < scene.count; b++) {
+    // merging leaves copies of the vertices shared between the source meshes
+    Mesh* mesh = &scene.batches[b].mesh;
+    Mesh optimized;
+    if (optimizeMesh(mesh, &optimized, TextFormat("static batch %i", b))) {
+      unloadMeshArrays(mesh);
+      *mesh = optimized;
+    }
+    scene.batches[b].bounds = GetMeshBoundingBox(*mesh);
+    UploadMesh(mesh, false);
+    staticBatch* batch = &scene.batches[b];
+    batch->lodCount = loadMeshLods(mesh, batch->lods, batch->lodErrors, TextFormat("static batch %i", b));
+    for (int l = 0; l < batch->lodCount; l++) {
+      UploadMesh(&batch->lods[l], false);
+      releaseMeshData(&batch->lods[l]);
     }
+    releaseMeshData(mesh);
   }
+  TraceLog(LOG_INFO, "SCENE: Merged %i meshes into %i batches", meshCount, scene.count);
+  return scene;
 }
 
-void updateCamera(Camera* camera) {
-  // mouse
-  float rotateSensitivity = 0.003f;
-  Vector2 mousePositionDelta = GetMouseDelta();
-  CameraYaw(camera, -mousePositionDelta.x*rotateSensitivity, false);
-  CameraPitch(camera, -mousePositionDelta.y*rotateSensitivity, true, false, false);
+void unloadStaticScene(staticScene* scene) {
+  for (int b = 0; b < scene->count; b++) {
+    UnloadMesh(scene->batches[b].mesh);
+    for (int l = 0; l < scene->batches[b].lodCount; l++) UnloadMesh(scene->batches[b].lods[l]);
+    MemFree(scene->batches[b].material.maps); // the shaders and textures belong to the models
+  }
+  MemFree(scene->batches);
+}
 
-  // keyboard
-  float moveAmount = 15*GetFrameTime();
-  if (IsKeyDown(KEY_W)) CameraMoveForward(camera, moveAmount, true);
-  if (IsKeyDown(KEY_A)) CameraMoveRight(camera, -moveAmount, true);
-  if (IsKeyDown(KEY_S)) CameraMoveForward(camera, -moveAmount, true);
-  if (IsKeyDown(KEY_D)) CameraMoveRight(camera, moveAmount, true);
+// the coarsest level whose error would cover less than LOD_PIXEL_ERROR pixels from the camera
+const Mesh* staticBatchLod(const staticBatch* batch, Camera camera) {
+  Vector3 nearest = Vector3Clamp(camera.position, batch->bounds.min, batch->bounds.max);
+  float distance = Vector3Distance(camera.position, nearest);
+  float pixelsPerUnit = GetScreenHeight()/(2*tanf(camera.fovy*DEG2RAD/2)*fmaxf(distance, 0.001f));
+  const Mesh* mesh = &batch->mesh;
+  for (int l = 0; l < batch->lodCount && batch->lodErrors[l]*pixelsPerUnit < LOD_PIXEL_ERROR; l++) mesh = &batch->lods[l];
+  return mesh;
 }
 
-void randomizeUV(Model model) {
-  for (int i = 0; i < model.meshCount; i++) {
-    float* texcoords = (float*)MemAlloc(model.meshes[i].vertexCount*2*sizeof(float));
-    for (int j = 0; j < model.meshes[i].vertexCount*2; j++) {
-      texcoords[j] = (float)GetRandomValue(0,255)/255;
+void drawStaticScene(const staticScene* scene, Camera camera, const frustum* f, cullStats* stats) {
+  bool culling = true;
+  for (int b = 0; b < scene->count; b++) {
+    const staticBatch* batch = &scene->batches[b];
+    if (!boxInFrustum(f, batch->bounds)) {
+      stats->culled++;
+      continue;
     }
-    UpdateMeshBuffer(model.meshes[i], SHADER_LOC_VERTEX_TEXCOORD01, texcoords, model.meshes[i].vertexCount*2*sizeof(float), 0);
-    MemFree(texcoords);
+    stats->drawn++;
+    if (batch->doubleSided == culling) {
+      culling = !batch->doubleSided;
+      if (culling) rlEnableBackfaceCulling();
+      else rlDisableBackfaceCulling();
+    }
+    DrawMesh(*staticBatchLod(batch, camera), batch->material, MatrixIdentity());
   }
+  if (!culling) rlEnableBackfaceCulling();
 }
 
 bool hasAward(catch caught[], int caughtCount, catch award) {
@@ -164,14 +3192,28 @@ void drawTextCentered(Font font, const char *text, float y, float fontSize, floa
   DrawTextEx(font, text, (Vector2){ x, y }, fontSize, spacing, tint);
 }
 
-int main(void) {
+int main(int argc, char** argv) {
   SetTraceLogLevel(LOG_WARNING);
 
+  int quality = WAVE_QUALITY;
+  bool loop = WAVE_LOOP;
+  bool gpuPicking = GPU_PICKING;
+  int textureSize = NOISE_TEXTURE_SIZE;
+  int textureMaxSize = TEXTURE_MAX_SIZE;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--wave-quality=", 15) == 0) quality = findWaveQuality(argv[i] + 15);
+    if (strcmp(argv[i], "--wave-loop") == 0) loop = true;
+    if (strcmp(argv[i], "--gpu-picking") == 0) gpuPicking = true;
+    if (strncmp(argv[i], "--texture-size=", 15) == 0) textureSize = TextToInteger(argv[i] + 15);
+    if (strncmp(argv[i], "--texture-max-size=", 19) == 0) textureMaxSize = TextToInteger(argv[i] + 19);
+  }
+
   // initialization
   //======================================================================================
   const int screenWidth = 1600;
   const int screenHeight = 900;
 
+  SetConfigFlags(FLAG_VSYNC_HINT);
   InitWindow(screenWidth, screenHeight, "An Ark For The Amigalites");
   InitAudioDevice();
 
@@ -195,10 +3237,12 @@ int main(void) {
   // noise
   fnl_state noise = fnlCreateState();
   noise.noise_type = FNL_NOISE_OPENSIMPLEX2;
+  threadPool noiseThreads = loadThreadPool();
+  fnl_pool noisePool = { poolParallelFor, &noiseThreads };
 
   // assets
-  Texture2D woodTexture = LoadTexture("assets/wood.jpg");
-  Texture2D sailTexture = LoadTexture("assets/sail.jpg");
+  Texture2D woodTexture = loadNoiseTexture("assets/wood.jpg", textureSize, textureMaxSize, &noisePool);
+  Texture2D sailTexture = loadNoiseTexture("assets/sail.jpg", textureSize, textureMaxSize, &noisePool);
   Model ship = LoadModel("assets/ship.glb");
   randomizeUV(ship);
   ship.materials[2].maps[MATERIAL_MAP_DIFFUSE].texture = woodTexture; // sides
@@ -218,7 +3262,7 @@ int main(void) {
   ladder.transform = MatrixMultiply(ladder.transform, MatrixRotate((Vector3){0,1,0}, 7*PI/32));
   ladder.transform = MatrixMultiply(ladder.transform, MatrixTranslate(12.5f, -10, -9.5f));
 
-  Model jukebox = LoadModel("assets/jukebox.glb");
+  Model jukebox = loadOptimizedModel("assets/jukebox.glb");
   jukebox.meshes[3].triangleCount = 0; // the glass doesn't render correctly; disable it
   jukebox.transform = MatrixMultiply(jukebox.transform, MatrixScale(4.2f, 4.2f, 4.2f));
   jukebox.transform = MatrixMultiply(jukebox.transform, MatrixRotate((Vector3){0,1,0}, -7*PI/32));
@@ -231,7 +3275,7 @@ int main(void) {
   easel.transform = MatrixMultiply(easel.transform, MatrixRotate((Vector3){0,1,0}, PI/2));
   easel.transform = MatrixMultiply(easel.transform, MatrixTranslate(-18.6f, -1, 1.7f));
 
-  Model canvas = LoadModel("assets/canvas.glb");
+  Model canvas = loadOptimizedModel("assets/canvas.glb");
   canvas.transform = MatrixMultiply(canvas.transform, MatrixScale(0.2f, 0.2f, 0.2f));
   canvas.transform = MatrixMultiply(canvas.transform, MatrixRotate((Vector3){0,0,1}, 59*PI/64));
   canvas.transform = MatrixMultiply(canvas.transform, MatrixTranslate(-19.8f, 2.0f, -0.8f));
@@ -242,10 +3286,13 @@ int main(void) {
   paint.transform = MatrixMultiply(paint.transform, MatrixTranslate(-19.398f, 2.093f, -0.780f));
   Image paintImg = LoadImageFromTexture(canvas.materials[11].maps[MATERIAL_MAP_DIFFUSE].texture);
   ImageResize(&paintImg, 1888, 1360);
-  paint.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = LoadTextureFromImage(paintImg);
-  Image paintImgModified = paintImg;
-  Image paintSticker;
-  Image paintStickerScaled;
+  // only updated when a sticker moves, too rarely to be worth a stream's extra copies
+  Texture2D paintTexture = LoadTextureFromImage(paintImg);
+  paint.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = paintTexture;
+  // the sticker being placed is drawn straight onto paintImg, with what it covers kept aside to undo it
+  paintPatch paintUnder = { 0 };
+  Image paintSticker = { 0 }; // owned by stickers
+  Image paintStickerScaled = { 0 };
   Rectangle paintStickerRect = { 0 };
   float paintStickerScale = 1;
 
@@ -310,11 +3357,13 @@ int main(void) {
   for (int i = 0; i < allStickerCount; i++) caughtStickers[i] = allStickers[i];
   caughtStickerCount = allStickerCount;
   #endif
+  stickerCache stickers;
+  startStickerCache(&stickers);
 
-  Texture2D reelTexture = LoadTexture("assets/reel.jpg");
-  Texture2D lineTexture = LoadTexture("assets/line.jpg");
-  Texture2D metalTexture = LoadTexture("assets/metal.jpg");
-  Model pole = LoadModel("assets/pole.glb");
+  Texture2D reelTexture = loadNoiseTexture("assets/reel.jpg", textureSize, textureMaxSize, &noisePool);
+  Texture2D lineTexture = loadNoiseTexture("assets/line.jpg", textureSize, textureMaxSize, &noisePool);
+  Texture2D metalTexture = loadNoiseTexture("assets/metal.jpg", textureSize, textureMaxSize, &noisePool);
+  Model pole = loadOptimizedModel("assets/pole.glb");
   pole.materials[1].maps[MATERIAL_MAP_DIFFUSE].texture = reelTexture; // reel
   pole.materials[2].maps[MATERIAL_MAP_DIFFUSE].texture = woodTexture; // rod
   pole.materials[3].maps[MATERIAL_MAP_DIFFUSE].texture = lineTexture; // line
@@ -322,13 +3371,15 @@ int main(void) {
   pole.materials[5].maps[MATERIAL_MAP_DIFFUSE].texture = metalTexture; // trim
   pole.materials[6].maps[MATERIAL_MAP_DIFFUSE].texture = metalTexture; // guide
   float poleCastAngle = 0;
+  float previousPoleCastAngle = 0; // as of the tick before, for drawing in between
 
-  Model bobber = LoadModel("assets/bobber.glb");
+  Model bobber = loadOptimizedModel("assets/bobber.glb");
   Vector3 bobberVel = { 0 };
   Vector3 bobberPos = { 0 };
+  Vector3 previousBobberPos = { 0 };
   Vector3 bobberOnPolePos = { 0 };
 
-  Texture2D goldTexture = LoadTexture("assets/exclamation.jpg");
+  Texture2D goldTexture = loadSurfaceTexture("assets/exclamation.jpg", textureMaxSize);
   Model exclamation = LoadModel("assets/exclamation.glb");
   randomizeUV(exclamation);
   exclamation.materials[2].maps[MATERIAL_MAP_DIFFUSE].texture = goldTexture;
@@ -337,36 +3388,63 @@ int main(void) {
   exclamation.transform = MatrixMultiply(exclamation.transform, MatrixRotate((Vector3){1,0,0}, PI));
   Vector3 exclamationPos = { 0 };
 
-  Model cd = LoadModel("assets/cd.glb");
+  Model cd = loadOptimizedModel("assets/cd.glb");
   bool cdCaught = false;
 
-  Model waves = LoadModelFromMesh(GenMeshPlane(WAVE_SPAN, WAVE_SPAN, WAVE_PEAKS-1, WAVE_PEAKS-1));
-  waves.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = LoadTexture("assets/waves.jpg");
-  int i = 0;
-  float ztex = 0;
-  bool zdir = true;
-  for (int z = 0; z < WAVE_PEAKS; z++) {
-    float xtex = 0;
-    bool xdir = true;
-    for (int x = 0; x < WAVE_PEAKS; x++) {
-      waves.meshes[0].texcoords[i++] = xtex;
-      waves.meshes[0].texcoords[i++] = ztex;
-      if (FloatEquals(xtex, 0) || FloatEquals(xtex, 1)) xdir = !xdir;
-      xtex += (xdir?-1:1)*(float)WAVE_TEX_TILES/WAVE_PEAKS;
-    }
-    if (FloatEquals(ztex, 0) || FloatEquals(ztex, 1)) zdir = !zdir;
-    ztex += (zdir?-1:1)*(float)WAVE_TEX_TILES/WAVE_PEAKS;
-  }
-  UpdateMeshBuffer(waves.meshes[0], SHADER_LOC_VERTEX_TEXCOORD01, waves.meshes[0].texcoords, waves.meshes[0].vertexCount*2*sizeof(float), 0);
-  waves.transform = MatrixTranslate(0, -13, 0);
-
-  Texture2D skyTexture = LoadTexture("assets/sky.jpg");
-  Model sky = LoadModelFromMesh(GenMeshSphere((float)WAVE_SPAN/2, 64, 64));
-  sky.transform = MatrixTranslate(0, -200, 0);
-  sky.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = skyTexture;
-
-  Model collisionObjects[4] = { ship, jukebox, easel, canvas };
-  int collisionObjectCount = sizeof(collisionObjects)/sizeof(Model);
+  worker waveWorker;
+  workerStart(&waveWorker);
+  ocean waves = loadOcean(&noise, &waveWorker, &noisePool, WAVE_SPECTRUM, loop, quality);
+  waves.model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = loadNoiseTexture("assets/waves.jpg", textureSize, textureMaxSize, &noisePool);
+
+  Model sky = loadSkybox(loadSkyCubemap("assets/sky.jpg", textureMaxSize, &noisePool));
+
+  // the canvas is drawn without backface culling, as it always has been
+  Model sceneryModels[] = { ship, ladder, jukebox, easel, canvas };
+  bool sceneryDoubleSided[] = { false, false, false, false, true };
+  staticScene scenery = loadStaticScene(sceneryModels, sceneryDoubleSided, sizeof(sceneryModels)/sizeof(Model));
+  // the models drawn on their own are culled mesh by mesh
+  BoundingBox* paintBounds = loadMeshBounds(paint);
+  BoundingBox* poleBounds = loadMeshBounds(pole);
+  BoundingBox* bobberBounds = loadMeshBounds(bobber);
+  BoundingBox* exclamationBounds = loadMeshBounds(exclamation);
+  BoundingBox* cdBounds = loadMeshBounds(cd);
+  cullStats culling = { 0 };
+
+  // walking into them and aiming at them doesn't need their full detail
+  collisionProxy collisionObjects[4] = {
+    loadCollisionProxy(ship, 0.25f, "ship"),
+    loadCollisionProxy(jukebox, 0.25f, "jukebox"),
+    loadCollisionProxy(easel, 0.25f, "easel"),
+    loadCollisionProxy(canvas, 0.25f, "canvas"),
+  };
+  int collisionObjectCount = sizeof(collisionObjects)/sizeof(collisionProxy);
+
+  // what aiming at and pressing E opens
+  interactRegistry interactTargets = { 0 };
+  addInteractTarget(&interactTargets, INTERACT_JUKEBOX, &collisionObjects[1]);
+  addInteractTarget(&interactTargets, INTERACT_CANVAS, &collisionObjects[3]);
+
+  picker pick = { 0 };
+  pickable interactPickables[INTERACT_TARGETS];
+  if (gpuPicking) {
+    pick = loadPicker();
+    UploadMesh(&collisionObjects[1].mesh, false);
+    UploadMesh(&collisionObjects[3].mesh, false);
+    for (int i = 0; i < interactTargets.count; i++) {
+      interactPickables[i] = (pickable){ interactTargets.targets[i].proxy->mesh, MatrixIdentity(), false };
+    }
+  }
+
+  // the scenery is only drawn through its batches and collided with through its proxies from here on; the textures
+  // that came with the models stay, the batches use them
+  Matrix ladderTransform = ladder.transform;
+  BoundingBox ladderBounds = GetMeshBoundingBox(ladder.meshes[0]);
+  for (int i = 0; i < (int)(sizeof(sceneryModels)/sizeof(Model)); i++) UnloadModel(sceneryModels[i]);
+  // the rest keep only what's on the GPU, except the paint plane that's raycast
+  releaseModelData(pole);
+  releaseModelData(bobber);
+  releaseModelData(exclamation);
+  releaseModelData(cd);
 
   Texture2D keyW = LoadTexture("assets/controls/key_w.gif");
   Texture2D keyA = LoadTexture("assets/controls/key_a.gif");
@@ -462,7 +3540,12 @@ int main(void) {
   camera.fovy = 60.0f;
   camera.projection = CAMERA_PERSPECTIVE;
 
-  SetTargetFPS(60);
+  player body = { camera.position, camera.position };
+  float tickAccumulator = 0;
+
+  #ifdef __EMSCRIPTEN__
+  SetTargetFPS(60); // the wait at the end of each frame is what hands control back to the browser
+  #endif
 
   DisableCursor();
 
@@ -476,8 +3559,11 @@ int main(void) {
     UpdateMusicStream(hookedSfx);
     UpdateMusicStream(music);
 
-    genWaveVertices(&noise, waves.meshes[0].vertices);
-    UpdateMeshBuffer(waves.meshes[0], SHADER_LOC_VERTEX_POSITION, waves.meshes[0].vertices, waves.meshes[0].vertexCount*3*sizeof(float), 0);
+    updateOcean(&waves, camera.position, GetTime());
+    tuneOcean(&waves, GetFrameTime());
+
+    int ticks = simulationTicks(&tickAccumulator, GetFrameTime());
+    float tickAlpha = tickAccumulator*TICK_RATE;
 
     if (IsKeyPressed(KEY_H)) showHelp = !showHelp;
 
@@ -514,6 +3600,7 @@ int main(void) {
       if (IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_W)) (*menuSelected)--;
       *menuSelected += menuItemCount;
       *menuSelected %= menuItemCount;
+      if (mode == MODE_CANVAS) prefetchSticker(&stickers, menuItems[*menuSelected].file);
 
       if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_SPACE)) {
         if (mode == MODE_JUKEBOX) {
@@ -523,9 +3610,7 @@ int main(void) {
           PlayMusicStream(music);
           mode = MODE_FISHING;
         } else /* mode == MODE_CANVAS */ {
-          paintSticker = LoadImage(menuItems[*menuSelected].file);
-          ImageRotateCCW(&paintSticker);
-          paintImgModified = ImageCopy(paintImg);
+          paintSticker = getSticker(&stickers, menuItems[*menuSelected].file);
           EnableCursor();
           mode = MODE_PAINT;
         }
@@ -535,7 +3620,10 @@ int main(void) {
 
     case MODE_PAINT:
       if (IsKeyPressed(KEY_Q)) {
-        UpdateTexture(paint.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture, paintImg.data);
+        restorePaintPatch(&paintImg, &paintUnder);
+        UnloadImage(paintStickerScaled);
+        paintStickerScaled = (Image){ 0 };
+        UpdateTexture(paintTexture, paintImg.data);
         DisableCursor();
         mode = MODE_CANVAS;
         break;
@@ -548,11 +3636,20 @@ int main(void) {
       paintStickerRect.width = 0.1f*paintStickerScale*paintImg.width;
       paintStickerRect.height = 0.1f*paintStickerScale*((float)paintSticker.height/paintSticker.width)*paintImg.height;
 
-      RayCollision collision = GetRayCollisionModel(GetScreenToWorldRay(GetMousePosition(), camera), paint);
-      if (collision.hit) {
-        Vector3 p = Vector3Transform(collision.point, MatrixInvert(paint.transform));
-        paintStickerRect.x = paintImg.width*(p.x+0.5f) - paintStickerRect.width/2;
-        paintStickerRect.y = paintImg.height*(p.z+0.5f) - paintStickerRect.height/2;
+      if (gpuPicking) {
+        pickable canvasPickable = { paint.meshes[0], paint.transform, true };
+        pickResult picked = updatePicker(&pick, camera, GetMousePosition(), MODE_PAINT, &canvasPickable, 1);
+        if (picked.pass == MODE_PAINT && picked.id == 1) {
+          paintStickerRect.x = paintImg.width*picked.uv.x - paintStickerRect.width/2;
+          paintStickerRect.y = paintImg.height*picked.uv.y - paintStickerRect.height/2;
+        }
+      } else {
+        RayCollision collision = GetRayCollisionModel(GetScreenToWorldRay(GetMousePosition(), camera), paint);
+        if (collision.hit) {
+          Vector3 p = Vector3Transform(collision.point, MatrixInvert(paint.transform));
+          paintStickerRect.x = paintImg.width*(p.x+0.5f) - paintStickerRect.width/2;
+          paintStickerRect.y = paintImg.height*(p.z+0.5f) - paintStickerRect.height/2;
+        }
       }
 
       if (
@@ -570,16 +3667,17 @@ int main(void) {
         !FloatEquals(paintStickerRect.width, oldRect.width) ||
         !FloatEquals(paintStickerRect.height, oldRect.height)
       ) {
-        UnloadImage(paintImgModified);
-        paintImgModified = ImageCopy(paintImg);
-        ImageDraw(&paintImgModified, paintStickerScaled, (Rectangle){ 0, 0, paintStickerScaled.width, paintStickerScaled.height }, paintStickerRect, WHITE);
-        UpdateTexture(paint.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture, paintImgModified.data);
+        restorePaintPatch(&paintImg, &paintUnder);
+        paintUnder = savePaintPatch(paintImg, paintStickerRect);
+        ImageDraw(&paintImg, paintStickerScaled, (Rectangle){ 0, 0, paintStickerScaled.width, paintStickerScaled.height }, paintStickerRect, WHITE);
+        UpdateTexture(paintTexture, paintImg.data);
       }
 
       if (IsKeyPressed(KEY_SPACE) || IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-        UnloadImage(paintImg);
-        paintImg = ImageCopy(paintImgModified);
-        UnloadImage(paintImgModified);
+        // keep the sticker
+        unloadPaintPatch(&paintUnder);
+        UnloadImage(paintStickerScaled);
+        paintStickerScaled = (Image){ 0 };
         DisableCursor();
         mode = MODE_FISHING;
       }
@@ -587,62 +3685,94 @@ int main(void) {
       break;
 
     case MODE_FISHING:
-      ;Vector3 oldPos = camera.position;
       updateCamera(&camera);
-      playerPhysics(&camera, oldPos, collisionObjects, collisionObjectCount, ladder);
+      Vector3 walk = playerVelocity(&camera);
+      bool reelHeld = IsKeyDown(KEY_SPACE) || IsMouseButtonDown(MOUSE_BUTTON_LEFT);
 
-      Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+      for (int tick = 0; tick < ticks; tick++) {
+        playerStep(&body, walk, collisionObjects, collisionObjectCount, ladderTransform, ladderBounds);
 
-      collision = GetRayCollisionModel((Ray){ camera.position, forward }, jukebox);
-      bool jukeboxInteractable = collision.hit && collision.distance < 8;
-      if (jukeboxInteractable && IsKeyPressed(KEY_E)) {
-        interactable = false;
-        if (caughtSongCount >= 1) {
-          menuItems = caughtSongs;
-          menuItemCount = caughtSongCount;
-          menuSelected = &songSelected;
-          mode = MODE_JUKEBOX;
+        previousPoleCastAngle = poleCastAngle;
+        if (state == STATE_WINDING && reelHeld) {
+          poleCastAngle += 0.75f*PI*TICK_SECONDS;
         } else {
-          goFishFor = "Songs";
-          mode = MODE_GOFISH;
+          poleCastAngle -= 6*PI*TICK_SECONDS;
         }
-        break;
+        poleCastAngle = Clamp(poleCastAngle, 0, 2*PI/3);
+
+        previousBobberPos = bobberPos;
+        if (state == STATE_CASTING) {
+          Vector3 oldBobberPos = bobberPos;
+          bobberVel = Vector3ClampValue(Vector3Add(bobberVel, (Vector3){ 0, -30*TICK_SECONDS, 0 }), 0, 100000);
+          bobberPos = Vector3Add(bobberPos, Vector3Scale(bobberVel, TICK_SECONDS));
+
+          float surface = oceanHeight(&waves, oldBobberPos.x, oldBobberPos.z);
+          if (oldBobberPos.y >= surface && oldBobberPos.y - surface < 0.1) {
+            bobberPos = (Vector3){ oldBobberPos.x, surface, oldBobberPos.z };
+            state = STATE_CAST;
+          } else if (bobberPos.y < -13) {
+            state = STATE_CAST;
+          }
+        }
+
+        if (state == STATE_CAST && randomEvent(14)) {
+          state = STATE_HOOKED;
+          PlayMusicStream(hookedSfx);
+        }
+
+        if (state == STATE_HOOKED && randomEvent(4)) state = STATE_CAST;
+
+        if (state == STATE_REELING) bobberPos = Vector3MoveTowards(bobberPos, bobberOnPolePos, 2);
       }
 
-      collision = GetRayCollisionModel((Ray){ camera.position, forward }, canvas);
-      bool canvasInteractable = collision.hit && collision.distance < 8;
-      if (canvasInteractable && IsKeyPressed(KEY_E)) {
+      placePlayerCamera(&body, &camera, tickAlpha);
+
+      Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+
+      const interactTarget* target = NULL;
+      if (gpuPicking) {
+        Vector2 crosshair = { GetScreenWidth()/2.0f, GetScreenHeight()/2.0f };
+        pickResult picked = updatePicker(&pick, camera, crosshair, MODE_FISHING, interactPickables, interactTargets.count);
+        if (picked.pass == MODE_FISHING && picked.id > 0 && picked.distance < INTERACT_REACH) target = &interactTargets.targets[picked.id - 1];
+      } else {
+        target = queryInteractTargets(&interactTargets, (Ray){ camera.position, forward }, INTERACT_REACH);
+      }
+      interactable = target != NULL;
+      if (interactable && IsKeyPressed(KEY_E)) {
         interactable = false;
-        if (caughtStickerCount >= 1) {
-          menuItems = caughtStickers;
-          menuItemCount = caughtStickerCount;
-          menuSelected = &stickerSelected;
-          mode = MODE_CANVAS;
-        } else {
-          goFishFor = "Stickers";
-          mode = MODE_GOFISH;
+        if (target->kind == INTERACT_JUKEBOX) {
+          if (caughtSongCount >= 1) {
+            menuItems = caughtSongs;
+            menuItemCount = caughtSongCount;
+            menuSelected = &songSelected;
+            mode = MODE_JUKEBOX;
+          } else {
+            goFishFor = "Songs";
+            mode = MODE_GOFISH;
+          }
+        } else /* target->kind == INTERACT_CANVAS */ {
+          if (caughtStickerCount >= 1) {
+            menuItems = caughtStickers;
+            menuItemCount = caughtStickerCount;
+            menuSelected = &stickerSelected;
+            mode = MODE_CANVAS;
+          } else {
+            goFishFor = "Stickers";
+            mode = MODE_GOFISH;
+          }
         }
         break;
       }
 
-      interactable = jukeboxInteractable || canvasInteractable;
-
       if (state == STATE_POLE && (IsKeyPressed(KEY_SPACE) || IsMouseButtonPressed(MOUSE_BUTTON_LEFT))) {
         state = STATE_WINDING;
       }
 
-      if (state == STATE_WINDING && (IsKeyDown(KEY_SPACE) || IsMouseButtonDown(MOUSE_BUTTON_LEFT))) {
-        poleCastAngle += 0.75f*PI*GetFrameTime();
-      } else {
-        poleCastAngle -= 6*PI*GetFrameTime();
-      }
-      poleCastAngle = Clamp(poleCastAngle, 0, 2*PI/3);
-
       Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
       Matrix matScale = MatrixScale(0.6f, 0.4f, 0.4f);
       Matrix matRotation = MatrixMultiply(
         MatrixRotate(camera.up, atan2f(forward.x, forward.z)+PI),
-        MatrixRotate(right, poleCastAngle+atan2f(forward.y, sqrtf(forward.x*forward.x+forward.z*forward.z)))
+        MatrixRotate(right, Lerp(previousPoleCastAngle, poleCastAngle, tickAlpha)+atan2f(forward.y, sqrtf(forward.x*forward.x+forward.z*forward.z)))
       );
       Matrix matTranslation = MatrixTranslate(
         camera.position.x + forward.x * 2.0f + right.x * 1.0f,
@@ -670,29 +3800,8 @@ int main(void) {
         }
       }
 
-      if (state == STATE_CASTING) {
-        Vector3 oldBobberPos = bobberPos;
-        bobberVel = Vector3ClampValue(Vector3Add(bobberVel, (Vector3){ 0, -30*GetFrameTime(), 0 }), 0, 100000);
-        bobberPos = Vector3Add(bobberPos, Vector3Scale(bobberVel, GetFrameTime()));
-
-        RayCollision collision = GetRayCollisionModel((Ray){ oldBobberPos, (Vector3){ 0, -1, 0 } }, waves);
-        if (collision.hit && collision.distance < 0.1) {
-          bobberPos = collision.point;
-          state = STATE_CAST;
-        } else if (bobberPos.y < -13) {
-          state = STATE_CAST;
-        }
-      }
-
       if (state == STATE_CAST || state == STATE_HOOKED) {
-        bobberPos.y = 0;
-        RayCollision collision = GetRayCollisionModel((Ray){ bobberPos, (Vector3){ 0, -1, 0 } }, waves);
-        bobberPos.y = collision.point.y;
-
-        if (state == STATE_CAST && randomEvent(14)) {
-          state = STATE_HOOKED;
-          PlayMusicStream(hookedSfx);
-        }
+        bobberPos.y = oceanHeight(&waves, bobberPos.x, bobberPos.z);
 
         if (IsKeyPressed(KEY_SPACE) || IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
           cdCaught = state == STATE_HOOKED;
@@ -703,13 +3812,11 @@ int main(void) {
       if (state == STATE_HOOKED) {
         exclamationPos = bobberPos;
         exclamationPos.y += 6;
-
-        if (randomEvent(4)) state = STATE_CAST;
       }
 
       if (state == STATE_REELING) {
-        bobberPos = Vector3MoveTowards(bobberPos, bobberOnPolePos, 2);
-        if (Vector3Equals(bobberPos, bobberOnPolePos)) {
+        // the pole moves with the camera between ticks, so it's caught once it's within a tick's reel
+        if (Vector3Distance(bobberPos, bobberOnPolePos) <= 2) {
           if (cdCaught) {
             for (int i = 0; i < 10; i++) {
               int rand = GetRandomValue(0, allSongCount+allStickerCount-1);
@@ -733,7 +3840,8 @@ int main(void) {
           state = STATE_POLE;
         }
         if (cdCaught) {
-          cd.transform = MatrixMultiply(MatrixMultiply(MatrixScale(0.005f, 0.005f, 0.005f), MatrixRotateY(atan2f(forward.x, forward.z))), MatrixTranslate(bobberPos.x, bobberPos.y-0.8f, bobberPos.z));
+          Vector3 bobberShown = Vector3Lerp(previousBobberPos, bobberPos, tickAlpha);
+          cd.transform = MatrixMultiply(MatrixMultiply(MatrixScale(0.005f, 0.005f, 0.005f), MatrixRotateY(atan2f(forward.x, forward.z))), MatrixTranslate(bobberShown.x, bobberShown.y-0.8f, bobberShown.z));
         }
       }
 
@@ -753,28 +3861,33 @@ int main(void) {
 
         BeginMode3D(camera);
 
-          rlDisableBackfaceCulling();
-            DrawModel(sky, camera.position, 1, WHITE);
-            DrawModel(canvas, Vector3Zero(), 1, WHITE);
-          rlEnableBackfaceCulling();
+          frustum view = loadFrustum(MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+          culling = (cullStats){ 0 };
+
+          drawStaticScene(&scenery, camera, &view, &culling);
 
-          DrawModel(waves, Vector3Zero(), 1, WHITE);
+          drawOcean(&waves);
 
-          DrawModel(ship, Vector3Zero(), 1, WHITE);
-          DrawModel(ladder, Vector3Zero(), 1, WHITE);
-          DrawModel(jukebox, Vector3Zero(), 1, WHITE);
-          DrawModel(easel, Vector3Zero(), 1, WHITE);
-          DrawModel(paint, Vector3Zero(), 1, WHITE);
+          drawModelCulled(paint, paintBounds, Vector3Zero(), 1, WHITE, &view, &culling);
 
           if (mode == MODE_FISHING || mode == MODE_AWARD) {
-            DrawModel(pole, Vector3Zero(), 1, WHITE);
-            DrawModel(bobber, bobberPos, 0.01f, RED);
+            drawModelCulled(pole, poleBounds, Vector3Zero(), 1, WHITE, &view, &culling);
+            // in flight it's drawn between ticks, otherwise it follows the pole or the waves every frame
+            Vector3 bobberShown = state == STATE_CASTING || state == STATE_REELING ? Vector3Lerp(previousBobberPos, bobberPos, tickAlpha) : bobberPos;
+            drawModelCulled(bobber, bobberBounds, bobberShown, 0.01f, RED, &view, &culling);
             if (state != STATE_POLE && state != STATE_WINDING)
-              DrawLine3D(bobberPos, bobberOnPolePos, WHITE);
-            if (state == STATE_HOOKED) DrawModel(exclamation, exclamationPos, 1, WHITE);
-            if (cdCaught) DrawModel(cd, Vector3Zero(), 1, WHITE);
+              DrawLine3D(bobberShown, bobberOnPolePos, WHITE);
+            if (state == STATE_HOOKED) drawModelCulled(exclamation, exclamationBounds, exclamationPos, 1, WHITE, &view, &culling);
+            if (cdCaught) drawModelCulled(cd, cdBounds, Vector3Zero(), 1, WHITE, &view, &culling);
           }
 
+          // last, so it only shades pixels nothing else covered
+          rlDisableBackfaceCulling();
+          rlDisableDepthMask();
+            DrawModel(sky, Vector3Zero(), 1, WHITE);
+          rlEnableDepthMask();
+          rlEnableBackfaceCulling();
+
         EndMode3D();
       }
 
@@ -855,6 +3968,7 @@ int main(void) {
 
       #if SHOW_FPS
       DrawFPS(10, 10);
+      DrawText(TextFormat("%i draws, %i culled", culling.drawn, culling.culled), 10, 30, 20, LIME);
       #endif
 
     EndDrawing();
@@ -862,6 +3976,22 @@ int main(void) {
 
   // de-initialization
   //======================================================================================
+  MemFree(paintBounds);
+  MemFree(poleBounds);
+  MemFree(bobberBounds);
+  MemFree(exclamationBounds);
+  MemFree(cdBounds);
+  for (int i = 0; i < collisionObjectCount; i++) unloadCollisionProxy(&collisionObjects[i]);
+  unloadPlayer(&body);
+  if (gpuPicking) unloadPicker(&pick);
+  unloadStaticScene(&scenery);
+  unloadSkybox(sky);
+  unloadOcean(&waves);
+  workerStop(&waveWorker);
+  stopStickerCache(&stickers);
+  unloadThreadPool(&noiseThreads);
+  UnloadTexture(paintTexture);
+
   CloseWindow();
 
   return 0;